@@ -0,0 +1,467 @@
+// bench/ascii_bench.cpp
+// 转换和渲染核心的微基准测试（ascii_bench 目标）。
+// 输入都是固定种子生成的合成图片和网格，不读取磁盘上的图片，结果在不同机器、不同运行之间可比。
+// 每个用例先预热一次，再把迭代次数翻倍直到一轮耗时超过 --min-time，重复 --repetitions 轮取中位数；
+// 分配次数和字节数在单独的一轮中用 AllocationTracker 统计，不影响计时。
+// 结果以 JSON 写到标准输出（或 --output）；--baseline 与之前保存的结果比较，变慢超过 --threshold 时返回 1。
+
+#include "conversion/image_converter.h"
+#include "rendering/PngRenderer.h"
+#include "rendering/HtmlRenderer.h"
+#include "rendering/SvgRenderer.h"
+#include "rendering/RenderUtils.h"
+#include "utils/AllocationTracker.h"
+#include "utils/Logger.h"
+#include "utils/Trace.h"
+#include <nlohmann/json.hpp>
+#include <stb/stb_image_write.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr int REPORT_VERSION = 1;
+constexpr double BYTES_PER_MB = 1024.0 * 1024.0;
+
+struct Options {
+    double minTimeSeconds = 0.2;
+    int repetitions = 5;
+    std::string filter;          // 只运行名称包含该子串的用例
+    std::string fontPath = ASCII_BENCH_DEFAULT_FONT;
+    std::string outputPath;      // 为空时写到标准输出
+    std::string baselinePath;
+    double thresholdPercent = 10.0;
+};
+
+// 一个用例：op 执行一次被测操作；cells/bytes 为每次操作处理的字符数和字节数（0 表示不适用）
+struct Benchmark {
+    std::string name;
+    std::string group;
+    json params;
+    uint64_t cells = 0;
+    uint64_t bytes = 0;           // 用于 MB/s：输入或输出的字节数，见 bytesLabel
+    std::string bytesLabel;
+    std::function<void()> op;
+    std::vector<const char*> stages; // 额外报告这些 Trace 阶段每次操作的耗时
+};
+
+// 防止结果被优化掉
+volatile uint64_t g_sink = 0;
+
+// 只统计写入字节数的 sink：渲染器的输出不落盘，测得的是生成本身
+class CountingSink : public OutputSink {
+public:
+    bool write(const void*, size_t size) override {
+        m_bytes += size;
+        return true;
+    }
+    std::string describe() const override { return "counting sink"; }
+    uint64_t bytes() const { return m_bytes; }
+
+private:
+    uint64_t m_bytes = 0;
+};
+
+// xorshift64*：固定种子，结果与平台无关
+class Random {
+public:
+    explicit Random(uint64_t seed) : m_state(seed) {}
+    uint32_t next() {
+        m_state ^= m_state >> 12;
+        m_state ^= m_state << 25;
+        m_state ^= m_state >> 27;
+        return static_cast<uint32_t>((m_state * 0x2545F4914F6CDD1DULL) >> 32);
+    }
+
+private:
+    uint64_t m_state;
+};
+
+// 渐变加噪声的 RGB 图片：亮度覆盖整个字符集，颜色在相邻像素间变化
+std::vector<unsigned char> makeImage(int width, int height) {
+    std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * OUTPUT_CHANNELS);
+    Random random(0x9E3779B97F4A7C15ULL ^ (static_cast<uint64_t>(width) << 32) ^ static_cast<uint64_t>(height));
+    size_t i = 0;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const int noise = static_cast<int>(random.next() & 63) - 32;
+            pixels[i++] = static_cast<unsigned char>(std::clamp(x * 255 / std::max(1, width - 1) + noise, 0, 255));
+            pixels[i++] = static_cast<unsigned char>(std::clamp(y * 255 / std::max(1, height - 1) + noise, 0, 255));
+            pixels[i++] = static_cast<unsigned char>(std::clamp(((x ^ y) & 255) + noise, 0, 255));
+        }
+    }
+    return pixels;
+}
+
+std::vector<std::vector<CharColorInfo>> makeGrid(int sourceWidth, int sourceHeight, int columns) {
+    const std::vector<unsigned char> pixels = makeImage(sourceWidth, sourceHeight);
+    auto result = convertPixelsToAscii(pixels.data(), sourceWidth, sourceHeight, OUTPUT_CHANNELS, columns, 2.0);
+    return result ? std::move(result->data) : std::vector<std::vector<CharColorInfo>>();
+}
+
+uint64_t cellCount(const std::vector<std::vector<CharColorInfo>>& grid) {
+    return grid.empty() ? 0 : static_cast<uint64_t>(grid.size()) * grid[0].size();
+}
+
+// 文字画面一样的画布：大块背景加稀疏的前景笔画，压缩特性接近 PngRenderer 的真实输出
+std::vector<unsigned char> makeCanvas(int width, int height) {
+    std::vector<unsigned char> canvas(static_cast<size_t>(width) * height * OUTPUT_CHANNELS, 0xC8);
+    Random random(42);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if ((x % 9) < 6 && (y % 17) < 12 && (random.next() & 7) == 0) {
+                unsigned char* pixel = &canvas[(static_cast<size_t>(y) * width + x) * OUTPUT_CHANNELS];
+                pixel[0] = pixel[1] = pixel[2] = static_cast<unsigned char>(random.next() & 127);
+            }
+        }
+    }
+    return canvas;
+}
+
+void stbWriteCallback(void* context, void* data, int size) {
+    static_cast<CountingSink*>(context)->write(data, static_cast<size_t>(size));
+}
+
+const char* schemeName(ColorScheme scheme) {
+    return RenderUtils::usesPixelColor(scheme) ? "color" : "mono";
+}
+
+std::vector<Benchmark> buildBenchmarks(const Options& options, Config& config) {
+    std::vector<Benchmark> benchmarks;
+
+    // --- 转换：降采样和字符映射（generateAsciiData），按源图尺寸和目标宽度 ---
+    const std::pair<int, int> sourceSizes[] = {{640, 480}, {1920, 1080}, {4000, 3000}};
+    const int widths[] = {80, 256, 1024};
+    for (const auto& size : sourceSizes) {
+        auto pixels = std::make_shared<std::vector<unsigned char>>(makeImage(size.first, size.second));
+        for (int width : widths) {
+            Benchmark b;
+            b.group = "convert";
+            b.name = "convert/" + std::to_string(size.first) + "x" + std::to_string(size.second) + "/w" + std::to_string(width);
+            b.params = {{"sourceWidth", size.first}, {"sourceHeight", size.second}, {"columns", width}};
+            const int rows = std::max(1, static_cast<int>(std::lround(static_cast<double>(size.second) * width / (size.first * 2.0))));
+            b.cells = static_cast<uint64_t>(width) * rows;
+            b.bytes = pixels->size();
+            b.bytesLabel = "input";
+            b.op = [pixels, size, width] {
+                auto result = convertPixelsToAscii(pixels->data(), size.first, size.second, OUTPUT_CHANNELS, width, 2.0);
+                g_sink = g_sink + (result ? result->data.size() : 0);
+            };
+            benchmarks.push_back(std::move(b));
+        }
+    }
+
+    // --- 渲染：同一网格按单色和按像素着色两类方案 ---
+    auto grid = std::make_shared<std::vector<std::vector<CharColorInfo>>>(makeGrid(1920, 1080, 256));
+    const uint64_t gridCells = cellCount(*grid);
+    const ColorScheme schemes[] = {ColorScheme::BLACK_ON_WHITE, ColorScheme::COLOR_ON_BLACK};
+    auto pngRenderer = std::make_shared<PngRenderer>();
+    auto htmlRenderer = std::make_shared<HtmlRenderer>();
+    auto svgRenderer = std::make_shared<SvgRenderer>();
+    const std::pair<const char*, std::shared_ptr<IRenderer>> renderers[] = {
+        {"png", pngRenderer}, {"html", htmlRenderer}, {"svg", svgRenderer}};
+    for (const auto& renderer : renderers) {
+        for (ColorScheme scheme : schemes) {
+            Benchmark b;
+            b.group = std::string("render ") + renderer.first;
+            b.name = std::string("render/") + renderer.first + "/" + schemeName(scheme) + "/256";
+            b.params = {{"format", renderer.first}, {"scheme", colorSchemeToString(scheme)}, {"columns", 256},
+                        {"rows", grid->size()}};
+            b.cells = gridCells;
+            CountingSink probe;
+            renderer.second->render(*grid, probe, config, scheme);
+            b.bytes = probe.bytes();
+            b.bytesLabel = "output";
+            std::shared_ptr<IRenderer> target = renderer.second;
+            b.op = [target, grid, &config, scheme] {
+                CountingSink sink;
+                target->render(*grid, sink, config, scheme);
+                g_sink = g_sink + sink.bytes();
+            };
+            if (renderer.second == pngRenderer) {
+                b.stages = {"rasterize", "encode png"}; // 字形绘制与编码分开报告
+            }
+            benchmarks.push_back(std::move(b));
+        }
+    }
+
+    // --- 字体加载：每次使用新的渲染器，字形图集不命中缓存 ---
+    {
+        Benchmark b;
+        b.group = "font";
+        b.name = "font/load/" + std::to_string(static_cast<int>(config.fontSize)) + "px";
+        b.params = {{"font", options.fontPath}, {"fontSize", config.fontSize}};
+        std::vector<std::vector<CharColorInfo>> single = {{CharColorInfo{'@', {0, 0, 0}}}};
+        auto tiny = std::make_shared<std::vector<std::vector<CharColorInfo>>>(std::move(single));
+        b.op = [tiny, &config] {
+            PngRenderer fresh;
+            CountingSink sink;
+            fresh.render(*tiny, sink, config, ColorScheme::BLACK_ON_WHITE);
+            g_sink = g_sink + sink.bytes();
+        };
+        b.stages = {"font atlas"};
+        benchmarks.push_back(std::move(b));
+    }
+
+    // --- PNG 编码：合成的文字画布，按原始像素字节计 MB/s ---
+    const std::pair<int, int> canvasSizes[] = {{1920, 1080}, {3840, 2160}};
+    for (const auto& size : canvasSizes) {
+        auto canvas = std::make_shared<std::vector<unsigned char>>(makeCanvas(size.first, size.second));
+        Benchmark b;
+        b.group = "encode png";
+        b.name = "encode/png/" + std::to_string(size.first) + "x" + std::to_string(size.second);
+        b.params = {{"width", size.first}, {"height", size.second}};
+        b.bytes = canvas->size();
+        b.bytesLabel = "input";
+        b.op = [canvas, size] {
+            CountingSink sink;
+            stbi_write_png_to_func(stbWriteCallback, &sink, size.first, size.second, OUTPUT_CHANNELS,
+                                   canvas->data(), size.first * OUTPUT_CHANNELS);
+            g_sink = g_sink + sink.bytes();
+        };
+        benchmarks.push_back(std::move(b));
+    }
+
+    if (!options.filter.empty()) {
+        benchmarks.erase(std::remove_if(benchmarks.begin(), benchmarks.end(),
+                                        [&](const Benchmark& b) { return b.name.find(options.filter) == std::string::npos; }),
+                         benchmarks.end());
+    }
+    return benchmarks;
+}
+
+double runBatch(const Benchmark& b, uint64_t iterations) {
+    const auto start = Clock::now();
+    for (uint64_t i = 0; i < iterations; ++i) {
+        b.op();
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+json runBenchmark(const Benchmark& b, const Options& options) {
+    b.op(); // 预热：字形图集、缓冲池、页缓存
+
+    // 找到一轮至少持续 minTime 的迭代次数
+    const double minTimeNs = options.minTimeSeconds * 1e9;
+    uint64_t iterations = 1;
+    double elapsed = runBatch(b, iterations);
+    while (elapsed < minTimeNs && iterations < (1ULL << 30)) {
+        const double perOp = std::max(elapsed / iterations, 1.0);
+        iterations = std::max(iterations * 2, static_cast<uint64_t>(minTimeNs * 1.1 / perOp));
+        elapsed = runBatch(b, iterations);
+    }
+
+    std::vector<double> nsPerOp;
+    nsPerOp.push_back(elapsed / iterations);
+    for (int r = 1; r < options.repetitions; ++r) {
+        nsPerOp.push_back(runBatch(b, iterations) / iterations);
+    }
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+    const double median = nsPerOp[nsPerOp.size() / 2];
+
+    // 单独一轮：分配统计和阶段耗时
+    Trace::StageTimes stageTimes;
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+    AllocationTracker::start();
+    {
+        Trace::ScopedStageTimes collectStages(&stageTimes);
+        AllocationTracker::Scope scope("bench");
+        b.op();
+        allocations = scope.getAllocations();
+        allocatedBytes = scope.getBytes();
+    }
+    AllocationTracker::stop();
+
+    json j = {
+        {"name", b.name},
+        {"group", b.group},
+        {"params", b.params},
+        {"iterations", iterations},
+        {"repetitions", nsPerOp.size()},
+        {"nsPerOp", median},
+        {"nsPerOpMin", nsPerOp.front()},
+        {"nsPerOpMax", nsPerOp.back()},
+        {"allocationsPerOp", allocations},
+        {"bytesAllocatedPerOp", allocatedBytes}
+    };
+    if (b.cells > 0) {
+        j["cells"] = b.cells;
+        j["nsPerCell"] = median / b.cells;
+    }
+    if (b.bytes > 0) {
+        j["bytes"] = b.bytes;
+        j["bytesMeasured"] = b.bytesLabel;
+        j["mbPerSecond"] = b.bytes / BYTES_PER_MB / (median / 1e9);
+    }
+    if (!b.stages.empty()) {
+        json stages = json::object();
+        for (const char* stage : b.stages) {
+            for (const auto& total : stageTimes.totalsNs) {
+                if (std::string(total.first) == stage) {
+                    stages[stage] = {{"nsPerOp", static_cast<double>(total.second)}};
+                    if (b.cells > 0) {
+                        stages[stage]["nsPerCell"] = static_cast<double>(total.second) / b.cells;
+                    }
+                }
+            }
+        }
+        j["stagesNs"] = std::move(stages);
+    }
+    return j;
+}
+
+// 与之前保存的结果按名称比较 nsPerOp；返回变慢超过阈值的用例数
+int compareWithBaseline(const json& results, const Options& options) {
+    std::ifstream file(options.baselinePath);
+    json baseline;
+    try {
+        file >> baseline;
+    } catch (const json::exception& e) {
+        std::cerr << "Error: Cannot read baseline '" << options.baselinePath << "': " << e.what() << std::endl;
+        return -1;
+    }
+    std::map<std::string, double> previous;
+    for (const auto& entry : baseline.value("results", json::array())) {
+        previous[entry.value("name", std::string())] = entry.value("nsPerOp", 0.0);
+    }
+
+    int regressions = 0;
+    std::fprintf(stderr, "\n%-36s %14s %14s %9s\n", "Benchmark", "Baseline ns", "Current ns", "Change");
+    for (const auto& entry : results) {
+        const std::string name = entry["name"].get<std::string>();
+        auto it = previous.find(name);
+        if (it == previous.end() || it->second <= 0.0) {
+            std::fprintf(stderr, "%-36s %14s %14.0f %9s\n", name.c_str(), "-", entry["nsPerOp"].get<double>(), "new");
+            continue;
+        }
+        const double current = entry["nsPerOp"].get<double>();
+        const double change = (current - it->second) / it->second * 100.0;
+        const bool regressed = change > options.thresholdPercent;
+        regressions += regressed ? 1 : 0;
+        std::fprintf(stderr, "%-36s %14.0f %14.0f %+8.1f%%%s\n", name.c_str(), it->second, current, change,
+                     regressed ? "  REGRESSION" : "");
+    }
+    return regressions;
+}
+
+void printUsage(const char* programName) {
+    std::cerr << "Usage: " << programName << " [options]\n"
+              << "  --filter <text>        Only run benchmarks whose name contains text.\n"
+              << "  --min-time <seconds>   Minimum duration of one timed repetition (default 0.2).\n"
+              << "  --repetitions <n>      Timed repetitions per benchmark; the median is reported (default 5).\n"
+              << "  --font <file>          TrueType font for the PNG and font benchmarks.\n"
+              << "  --output <file>        Write the JSON results to a file instead of stdout.\n"
+              << "  --baseline <file>      Compare with earlier results; exit 1 if any benchmark got slower\n"
+              << "  --threshold <percent>  by more than the threshold (default 10)." << std::endl;
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            return false;
+        }
+        static const char* const valueOptions[] = {"--filter", "--min-time", "--repetitions", "--font", "--output", "--baseline", "--threshold"};
+        if (std::find(std::begin(valueOptions), std::end(valueOptions), arg) == std::end(valueOptions)) {
+            std::cerr << "Error: Unknown option '" << arg << "'." << std::endl;
+            return false;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Error: Missing value for '" << arg << "'." << std::endl;
+            return false;
+        }
+        const std::string value = argv[++i];
+        try {
+            if (arg == "--filter") {
+                options.filter = value;
+            } else if (arg == "--min-time") {
+                options.minTimeSeconds = std::stod(value);
+            } else if (arg == "--repetitions") {
+                options.repetitions = std::max(1, std::stoi(value));
+            } else if (arg == "--font") {
+                options.fontPath = value;
+            } else if (arg == "--output") {
+                options.outputPath = value;
+            } else if (arg == "--baseline") {
+                options.baselinePath = value;
+            } else {
+                options.thresholdPercent = std::stod(value);
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid value '" << value << "' for " << arg << "." << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // end anonymous namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // 标准输出只留给 JSON；渲染器的 Info 日志（例如加载字体）不输出
+    Log::Options logOptions;
+    logOptions.level = Log::Level::Warning;
+    logOptions.allToStderr = true;
+    Log::start(logOptions);
+
+    Config config;
+    config.finalFontPath = options.fontPath;
+
+    json results = json::array();
+    for (const Benchmark& b : buildBenchmarks(options, config)) {
+        std::cerr << "Running " << b.name << "..." << std::endl;
+        results.push_back(runBenchmark(b, options));
+    }
+
+    json report = {
+        {"version", REPORT_VERSION},
+        {"minTimeSeconds", options.minTimeSeconds},
+        {"repetitions", options.repetitions},
+#if defined(NDEBUG)
+        {"optimized", true},
+#else
+        {"optimized", false},
+#endif
+        {"results", results}
+    };
+    if (options.outputPath.empty()) {
+        std::cout << report.dump(1) << std::endl;
+    } else {
+        std::ofstream file(options.outputPath);
+        file << report.dump(1) << std::endl;
+        if (!file) {
+            std::cerr << "Error: Failed to write '" << options.outputPath << "'." << std::endl;
+            return 1;
+        }
+    }
+
+    if (!options.baselinePath.empty()) {
+        const int regressions = compareWithBaseline(results, options);
+        if (regressions != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
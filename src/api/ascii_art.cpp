@@ -0,0 +1,150 @@
+#include "ascii_art.h"
+#include "conversion/image_converter.h"
+#include "rendering/PngRenderer.h"
+#include "rendering/HtmlRenderer.h"
+#include "rendering/SvgRenderer.h"
+#include "utils/Logger.h"
+
+#include <optional>
+
+namespace AsciiArt {
+
+namespace {
+
+constexpr const char* API_VERSION = "1.0.0";
+
+void appendText(const std::vector<std::vector<CharColorInfo>>& asciiData, std::vector<unsigned char>& output) {
+    output.clear();
+    if (!asciiData.empty()) {
+        output.reserve(asciiData.size() * (asciiData[0].size() + 1));
+    }
+    for (const auto& lineData : asciiData) {
+        for (const auto& charInfo : lineData) {
+            output.push_back(static_cast<unsigned char>(charInfo.character));
+        }
+        output.push_back('\n');
+    }
+}
+
+} // end anonymous namespace
+
+struct Context::Impl {
+    Config baseConfig;
+    PngRenderer pngRenderer; // 字形图集按字号缓存在渲染器内，随 Context 一起保留
+    HtmlRenderer htmlRenderer;
+    SvgRenderer svgRenderer;
+    std::string lastError;
+
+    bool fail(const std::string& message) {
+        lastError = message;
+        return false;
+    }
+
+    // 优先使用解码、转换或渲染过程中记录的第一条错误，它比通用消息更能说明原因
+    bool failWithThreadError(const std::string& fallback) {
+        const std::string reason = Log::getThreadError();
+        return fail(reason.empty() ? fallback : reason);
+    }
+
+    bool render(std::optional<AsciiConversionResult> conversion, const RenderOptions& options, std::vector<unsigned char>& output);
+    bool applyOptions(const RenderOptions& options, Config& config, ColorScheme& scheme);
+};
+
+bool Context::Impl::applyOptions(const RenderOptions& options, Config& config, ColorScheme& scheme) {
+    if (options.targetWidth <= 0 || options.aspectRatioCorrection <= 0 || options.fontSize <= 0 || options.htmlFontSizePt <= 0) {
+        return fail("targetWidth, aspectRatioCorrection, fontSize and htmlFontSizePt must be positive.");
+    }
+    const auto& schemeMap = getColorSchemeMap();
+    auto it = schemeMap.find(toLower(options.colorScheme));
+    if (it == schemeMap.end()) {
+        return fail("Unknown color scheme '" + options.colorScheme + "'.");
+    }
+    if (options.format == OutputFormat::Png && baseConfig.finalFontPath.empty()) {
+        return fail("PNG output requires a Context created with a font path.");
+    }
+
+    config = baseConfig;
+    config.targetWidth = options.targetWidth;
+    config.charAspectRatioCorrection = options.aspectRatioCorrection;
+    config.fontSize = options.fontSize;
+    config.htmlFontSizePt = options.htmlFontSizePt;
+    scheme = it->second;
+    return true;
+}
+
+bool Context::Impl::render(std::optional<AsciiConversionResult> conversion, const RenderOptions& options, std::vector<unsigned char>& output) {
+    if (!conversion) {
+        return failWithThreadError("Failed to decode or convert the input image.");
+    }
+
+    Config config;
+    ColorScheme scheme;
+    if (!applyOptions(options, config, scheme)) {
+        return false;
+    }
+
+    // 渲染器直接追加到调用方的缓冲区
+    output.clear();
+    MemorySink sink(output);
+    bool rendered = false;
+    switch (options.format) {
+        case OutputFormat::Png:  rendered = pngRenderer.render(conversion->data, sink, config, scheme); break;
+        case OutputFormat::Html: rendered = htmlRenderer.render(conversion->data, sink, config, scheme); break;
+        case OutputFormat::Svg:  rendered = svgRenderer.render(conversion->data, sink, config, scheme); break;
+        case OutputFormat::Text: appendText(conversion->data, output); rendered = true; break;
+    }
+    if (!rendered) {
+        return failWithThreadError("Rendering failed.");
+    }
+    lastError.clear();
+    return true;
+}
+
+Context::Context(const std::string& fontPath) : m_impl(std::make_unique<Impl>()) {
+    m_impl->baseConfig.finalFontPath = fontPath;
+    m_impl->baseConfig.fontFilename = fontPath;
+}
+
+Context::~Context() = default;
+Context::Context(Context&&) noexcept = default;
+Context& Context::operator=(Context&&) noexcept = default;
+
+bool Context::renderImage(const unsigned char* encodedData, size_t encodedLength,
+                          const RenderOptions& options, std::vector<unsigned char>& output) {
+    if (!encodedData || encodedLength == 0) {
+        return m_impl->fail("Input buffer is empty.");
+    }
+    // 参数错误时不必解码
+    Config config;
+    ColorScheme scheme;
+    if (!m_impl->applyOptions(options, config, scheme)) {
+        return false;
+    }
+    Log::clearThreadError();
+    return m_impl->render(convertImageBytesToAscii(encodedData, encodedLength, "memory buffer",
+                                                   options.targetWidth, options.aspectRatioCorrection),
+                          options, output);
+}
+
+bool Context::renderPixels(const unsigned char* pixels, int width, int height, int channels,
+                           const RenderOptions& options, std::vector<unsigned char>& output) {
+    Config config;
+    ColorScheme scheme;
+    if (!m_impl->applyOptions(options, config, scheme)) {
+        return false;
+    }
+    Log::clearThreadError();
+    return m_impl->render(convertPixelsToAscii(pixels, width, height, channels,
+                                               options.targetWidth, options.aspectRatioCorrection),
+                          options, output);
+}
+
+const std::string& Context::getLastError() const {
+    return m_impl->lastError;
+}
+
+const char* getVersionString() {
+    return API_VERSION;
+}
+
+} // namespace AsciiArt
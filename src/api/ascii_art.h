@@ -0,0 +1,63 @@
+#ifndef ASCII_ART_H
+#define ASCII_ART_H
+
+// 嵌入式 C++ API：在进程内把图片字节（或已解码的像素）直接转换为渲染结果字节，
+// 不经过文件系统。只依赖标准库类型，内部实现可以独立演进。
+
+#include "ascii_art_export.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace AsciiArt {
+
+enum class OutputFormat {
+    Png,
+    Html,
+    Svg,
+    Text // 每行一个 '\n' 结尾的纯文本字符画
+};
+
+struct RenderOptions {
+    int targetWidth = 512;                      // 每行字符数
+    double aspectRatioCorrection = 2.0;         // 字符高宽比修正
+    float fontSize = 12.0f;                     // PNG 字形高度 / SVG 字号（像素）
+    float htmlFontSizePt = 8.0f;                // HTML 字号（磅）
+    std::string colorScheme = "BlackOnWhite";   // 与 config.json 中 colorSchemes 的名称相同（不区分大小写）
+    OutputFormat format = OutputFormat::Png;
+};
+
+// 可复用的转换上下文：持有字体、字形图集和临时缓冲区，应在多次调用间保留。
+// 单个 Context 不是线程安全的；并发调用时每个线程使用自己的 Context。
+class ASCII_ART_API Context {
+public:
+    // fontPath：PNG 输出使用的 TrueType 字体；只生成 HTML/SVG/Text 时可以为空
+    explicit Context(const std::string& fontPath = std::string());
+    ~Context();
+
+    Context(Context&&) noexcept;
+    Context& operator=(Context&&) noexcept;
+    Context(const Context&) = delete;
+    Context& operator=(const Context&) = delete;
+
+    // 编码后的图片字节（PNG/JPEG/BMP/...）-> 渲染结果。失败时返回 false，原因见 getLastError()。
+    bool renderImage(const unsigned char* encodedData, size_t encodedLength,
+                     const RenderOptions& options, std::vector<unsigned char>& output);
+
+    // 紧密排列的 8 位像素（channels：1 灰度、2 灰度+Alpha、3 RGB、4 RGBA）-> 渲染结果
+    bool renderPixels(const unsigned char* pixels, int width, int height, int channels,
+                      const RenderOptions& options, std::vector<unsigned char>& output);
+
+    const std::string& getLastError() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+ASCII_ART_API const char* getVersionString();
+
+} // namespace AsciiArt
+
+#endif // ASCII_ART_H
@@ -0,0 +1,136 @@
+#include "ascii_art_c.h"
+#include "ascii_art.h"
+
+#include <cstdlib>
+#include <cstring>
+
+struct ascii_art_context {
+    AsciiArt::Context context;
+    std::string lastError; // 创建失败等不经过 Context 的错误
+
+    explicit ascii_art_context(const std::string& fontPath) : context(fontPath) {}
+};
+
+namespace {
+
+AsciiArt::RenderOptions toRenderOptions(const ascii_art_options* options) {
+    AsciiArt::RenderOptions result;
+    if (!options) {
+        return result;
+    }
+    // 只读取调用方结构体中实际存在的字段
+    if (options->struct_size >= offsetof(ascii_art_options, format) + sizeof(options->format)) {
+        result.targetWidth = options->target_width;
+        result.aspectRatioCorrection = options->aspect_ratio_correction;
+        result.fontSize = options->font_size;
+        result.htmlFontSizePt = options->html_font_size_pt;
+        if (options->color_scheme) {
+            result.colorScheme = options->color_scheme;
+        }
+        switch (options->format) {
+            case ASCII_ART_FORMAT_HTML: result.format = AsciiArt::OutputFormat::Html; break;
+            case ASCII_ART_FORMAT_SVG:  result.format = AsciiArt::OutputFormat::Svg; break;
+            case ASCII_ART_FORMAT_TEXT: result.format = AsciiArt::OutputFormat::Text; break;
+            case ASCII_ART_FORMAT_PNG:
+            default:                    result.format = AsciiArt::OutputFormat::Png; break;
+        }
+    }
+    return result;
+}
+
+// 把结果复制到 malloc 分配的缓冲区，调用方用 ascii_art_free 释放
+int exportOutput(ascii_art_context* context, const std::vector<unsigned char>& output,
+                 unsigned char** outData, size_t* outSize) {
+    unsigned char* buffer = static_cast<unsigned char*>(std::malloc(output.empty() ? 1 : output.size()));
+    if (!buffer) {
+        context->lastError = "Out of memory.";
+        return 1;
+    }
+    if (!output.empty()) {
+        std::memcpy(buffer, output.data(), output.size());
+    }
+    *outData = buffer;
+    *outSize = output.size();
+    return 0;
+}
+
+} // end anonymous namespace
+
+extern "C" {
+
+void ascii_art_options_init(ascii_art_options* options) {
+    if (!options) return;
+    AsciiArt::RenderOptions defaults;
+    options->struct_size = sizeof(ascii_art_options);
+    options->target_width = defaults.targetWidth;
+    options->aspect_ratio_correction = defaults.aspectRatioCorrection;
+    options->font_size = defaults.fontSize;
+    options->html_font_size_pt = defaults.htmlFontSizePt;
+    options->color_scheme = nullptr;
+    options->format = ASCII_ART_FORMAT_PNG;
+}
+
+ascii_art_context* ascii_art_context_create(const char* font_path) {
+    // 构造 Context 时的分配失败等异常不能穿过 C 接口
+    try {
+        return new ascii_art_context(font_path ? font_path : "");
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void ascii_art_context_destroy(ascii_art_context* context) {
+    delete context;
+}
+
+int ascii_art_render_image(ascii_art_context* context, const unsigned char* data, size_t length,
+                           const ascii_art_options* options, unsigned char** out_data, size_t* out_size) {
+    if (!context || !out_data || !out_size) return 1;
+    *out_data = nullptr;
+    *out_size = 0;
+    try {
+        std::vector<unsigned char> output;
+        context->lastError.clear();
+        if (!context->context.renderImage(data, length, toRenderOptions(options), output)) {
+            return 1;
+        }
+        return exportOutput(context, output, out_data, out_size);
+    } catch (const std::exception& e) {
+        context->lastError = e.what();
+        return 1;
+    }
+}
+
+int ascii_art_render_pixels(ascii_art_context* context, const unsigned char* pixels, int width, int height, int channels,
+                            const ascii_art_options* options, unsigned char** out_data, size_t* out_size) {
+    if (!context || !out_data || !out_size) return 1;
+    *out_data = nullptr;
+    *out_size = 0;
+    try {
+        std::vector<unsigned char> output;
+        context->lastError.clear();
+        if (!context->context.renderPixels(pixels, width, height, channels, toRenderOptions(options), output)) {
+            return 1;
+        }
+        return exportOutput(context, output, out_data, out_size);
+    } catch (const std::exception& e) {
+        context->lastError = e.what();
+        return 1;
+    }
+}
+
+void ascii_art_free(void* data) {
+    std::free(data);
+}
+
+const char* ascii_art_last_error(const ascii_art_context* context) {
+    if (!context) return "Invalid context.";
+    if (!context->lastError.empty()) return context->lastError.c_str();
+    return context->context.getLastError().c_str();
+}
+
+const char* ascii_art_version(void) {
+    return AsciiArt::getVersionString();
+}
+
+} // extern "C"
@@ -0,0 +1,60 @@
+#ifndef ASCII_ART_C_H
+#define ASCII_ART_C_H
+
+/* 纯 C API，封装 AsciiArt::Context，便于从 C 或其他语言的 FFI 调用。 */
+
+#include "ascii_art_export.h"
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ascii_art_context ascii_art_context;
+
+typedef enum ascii_art_format {
+    ASCII_ART_FORMAT_PNG = 0,
+    ASCII_ART_FORMAT_HTML = 1,
+    ASCII_ART_FORMAT_SVG = 2,
+    ASCII_ART_FORMAT_TEXT = 3
+} ascii_art_format;
+
+/* 先用 ascii_art_options_init 填充默认值再修改；struct_size 用于今后追加字段时保持二进制兼容 */
+typedef struct ascii_art_options {
+    size_t struct_size;
+    int target_width;
+    double aspect_ratio_correction;
+    float font_size;
+    float html_font_size_pt;
+    const char* color_scheme; /* NULL 表示 "BlackOnWhite" */
+    ascii_art_format format;
+} ascii_art_options;
+
+ASCII_ART_API void ascii_art_options_init(ascii_art_options* options);
+
+/* font_path 可以为 NULL（不生成 PNG 时）；创建失败时返回 NULL */
+ASCII_ART_API ascii_art_context* ascii_art_context_create(const char* font_path);
+ASCII_ART_API void ascii_art_context_destroy(ascii_art_context* context);
+
+/* 成功返回 0，*out_data 需用 ascii_art_free 释放；失败返回非 0，原因见 ascii_art_last_error */
+ASCII_ART_API int ascii_art_render_image(ascii_art_context* context,
+                                         const unsigned char* data, size_t length,
+                                         const ascii_art_options* options,
+                                         unsigned char** out_data, size_t* out_size);
+
+ASCII_ART_API int ascii_art_render_pixels(ascii_art_context* context,
+                                          const unsigned char* pixels, int width, int height, int channels,
+                                          const ascii_art_options* options,
+                                          unsigned char** out_data, size_t* out_size);
+
+ASCII_ART_API void ascii_art_free(void* data);
+
+ASCII_ART_API const char* ascii_art_last_error(const ascii_art_context* context);
+
+ASCII_ART_API const char* ascii_art_version(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* ASCII_ART_C_H */
@@ -0,0 +1,20 @@
+#ifndef ASCII_ART_EXPORT_H
+#define ASCII_ART_EXPORT_H
+
+// 公共 API 的符号导出宏。
+// 静态库：为空。共享库：构建时定义 ASCII_CORE_SHARED 和 ASCII_CORE_BUILDING，使用方只定义 ASCII_CORE_SHARED。
+#if defined(ASCII_CORE_SHARED)
+  #if defined(_WIN32) || defined(_WIN64)
+    #if defined(ASCII_CORE_BUILDING)
+      #define ASCII_ART_API __declspec(dllexport)
+    #else
+      #define ASCII_ART_API __declspec(dllimport)
+    #endif
+  #else
+    #define ASCII_ART_API __attribute__((visibility("default")))
+  #endif
+#else
+  #define ASCII_ART_API
+#endif
+
+#endif // ASCII_ART_EXPORT_H
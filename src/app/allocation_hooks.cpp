@@ -0,0 +1,149 @@
+// src/app/allocation_hooks.cpp
+// 替换全局 operator new/delete，把分配交给 AllocationTracker 统计（--track-allocations）。
+// 只链接进可执行文件：嵌入 ascii_core 的程序保留自己的分配器。
+// 释放时的大小通过分配器查询（malloc_usable_size 等），因此不需要在块前附加头部；未启用时只多一次原子读取。
+
+#include "utils/AllocationTracker.h"
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+namespace {
+
+size_t usableSize(void* ptr) {
+#if defined(_WIN32) || defined(_WIN64)
+    return _msize(ptr);
+#elif defined(__APPLE__)
+    return malloc_size(ptr);
+#else
+    return malloc_usable_size(ptr);
+#endif
+}
+
+size_t alignedUsableSize(void* ptr, std::align_val_t alignment) {
+#if defined(_WIN32) || defined(_WIN64)
+    return _aligned_msize(ptr, static_cast<size_t>(alignment), 0);
+#else
+    (void)alignment;
+    return usableSize(ptr);
+#endif
+}
+
+void* allocate(size_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+    for (;;) {
+        void* ptr = std::malloc(size);
+        if (ptr) {
+            if (AllocationTracker::isEnabled()) {
+                AllocationTracker::onAllocate(usableSize(ptr));
+            }
+            return ptr;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            return nullptr;
+        }
+        handler();
+    }
+}
+
+void* allocateAligned(size_t size, std::align_val_t alignment) {
+    const size_t align = static_cast<size_t>(alignment);
+    if (size == 0) {
+        size = 1;
+    }
+    for (;;) {
+#if defined(_WIN32) || defined(_WIN64)
+        void* ptr = _aligned_malloc(size, align);
+#else
+        void* ptr = nullptr;
+        if (posix_memalign(&ptr, align < sizeof(void*) ? sizeof(void*) : align, size) != 0) {
+            ptr = nullptr;
+        }
+#endif
+        if (ptr) {
+            if (AllocationTracker::isEnabled()) {
+                AllocationTracker::onAllocate(alignedUsableSize(ptr, alignment));
+            }
+            return ptr;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            return nullptr;
+        }
+        handler();
+    }
+}
+
+void release(void* ptr) noexcept {
+    if (!ptr) {
+        return;
+    }
+    if (AllocationTracker::isEnabled()) {
+        AllocationTracker::onRelease(usableSize(ptr));
+    }
+    std::free(ptr);
+}
+
+void releaseAligned(void* ptr, std::align_val_t alignment) noexcept {
+    if (!ptr) {
+        return;
+    }
+    if (AllocationTracker::isEnabled()) {
+        AllocationTracker::onRelease(alignedUsableSize(ptr, alignment));
+    }
+#if defined(_WIN32) || defined(_WIN64)
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void* allocateOrThrow(size_t size) {
+    void* ptr = allocate(size);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* allocateAlignedOrThrow(size_t size, std::align_val_t alignment) {
+    void* ptr = allocateAligned(size, alignment);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+} // end anonymous namespace
+
+void* operator new(size_t size) { return allocateOrThrow(size); }
+void* operator new[](size_t size) { return allocateOrThrow(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocateAlignedOrThrow(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocateAlignedOrThrow(size, alignment); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateAligned(size, alignment); }
+
+void operator delete(void* ptr) noexcept { release(ptr); }
+void operator delete[](void* ptr) noexcept { release(ptr); }
+void operator delete(void* ptr, size_t) noexcept { release(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { release(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { release(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { release(ptr); }
+void operator delete(void* ptr, std::align_val_t alignment) noexcept { releaseAligned(ptr, alignment); }
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept { releaseAligned(ptr, alignment); }
+void operator delete(void* ptr, size_t, std::align_val_t alignment) noexcept { releaseAligned(ptr, alignment); }
+void operator delete[](void* ptr, size_t, std::align_val_t alignment) noexcept { releaseAligned(ptr, alignment); }
+void operator delete(void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept { releaseAligned(ptr, alignment); }
+void operator delete[](void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept { releaseAligned(ptr, alignment); }
@@ -5,60 +5,309 @@
 #include "ui/cli_handler.h"
 #include "utils/PathManager.h"
 #include "core/processing_orchestrator.h"
+#include "core/run_report.h"
+#include "core/progress_reporter.h"
+#include "server/job_server.h"
+#include "server/job_client.h"
+#include "conversion/image_converter.h"
+#include "conversion/ascii_grid_file.h"
+#include "rendering/PngRenderer.h"
+#include "rendering/HtmlRenderer.h"
+#include "rendering/SvgRenderer.h"
+#include "utils/Logger.h"
+#include "utils/Trace.h"
+#include "utils/PerfCounters.h"
+#include "utils/AllocationTracker.h"
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <chrono>
+#include <cstdio>
+#include <memory>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 using namespace std::chrono;
 
+namespace {
+
+// 标准输入/输出按二进制处理（Windows 默认的文本模式会改写换行符）
+void setBinaryStdio() {
+#if defined(_WIN32) || defined(_WIN64)
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+}
+
+bool isStderrTerminal() {
+#if defined(_WIN32) || defined(_WIN64)
+    return _isatty(_fileno(stderr)) != 0;
+#else
+    return isatty(fileno(stderr)) != 0;
+#endif
+}
+
+// 恢复 std::cout 原来的缓冲区
+struct CoutRedirect {
+    std::streambuf* original = nullptr;
+    ~CoutRedirect() {
+        if (original) std::cout.rdbuf(original);
+    }
+};
+
+// 在返回前（工作线程和写线程都已结束后）写出跟踪文件
+struct TraceExport {
+    std::string path;
+    ~TraceExport() {
+        if (!path.empty()) {
+            Trace::writeChromeTrace(path);
+        }
+    }
+};
+
+bool readAllStdin(std::vector<unsigned char>& bytes) {
+    unsigned char chunk[64 * 1024];
+    size_t readCount;
+    while ((readCount = std::fread(chunk, 1, sizeof(chunk), stdin)) > 0) {
+        bytes.insert(bytes.end(), chunk, chunk + readCount);
+    }
+    return !std::ferror(stdin);
+}
+
+} // end anonymous namespace
+
 Application::Application(int argc, char* argv[]) : m_argc(argc), m_argv(argv) {}
 
 int Application::run() {
-    CLIHandler::printWelcomeMessage();
+    // --- 处理命令行参数 ---
+    CLIHandler::CommandLineOptions options;
+    std::filesystem::path programPath(m_argv[0]);
+    bool parsed = CLIHandler::parseCommandLine(m_argc, m_argv, options);
 
-    if (!initialize()) {
-        return 1; // 初始化失败，直接退出
+    // client 的标准输出只包含响应行，便于交给 jq 等工具处理
+    if (parsed && options.clientMode) {
+        if (options.clientRequest.empty()) {
+            return JobClient::submit(options.inputPath, std::cin, std::cout);
+        }
+        std::istringstream request(options.clientRequest);
+        return JobClient::submit(options.inputPath, request, std::cout);
     }
 
-    // --- 核心修改：处理命令行参数 ---
-    if (m_argc < 2) {
-        std::filesystem::path programPath(m_argv[0]);
-        CLIHandler::printUsage(programPath.filename().string());
-        return 1; // 参数不足，打印用法并退出
+    // 标准输出只留给渲染结果：其余输出（包括配置加载的日志）改写到标准错误
+    CoutRedirect coutRedirect;
+    if (parsed && !options.streamFormat.empty()) {
+        std::cout.flush();
+        coutRedirect.original = std::cout.rdbuf(std::cerr.rdbuf());
     }
 
-    std::string inputPathStr = m_argv[1];
-    
-    // 可选：处理 --help 或 -h 参数
-    if (inputPathStr == "--help" || inputPathStr == "-h") {
-        std::filesystem::path programPath(m_argv[0]);
+    // 日志由后台线程写出；直接打印到控制台的内容（配置、汇总）之前先 Log::flush()
+    Log::Options logOptions;
+    logOptions.level = options.verbosity < 0 ? Log::Level::Warning
+                     : options.verbosity > 0 ? Log::Level::Debug : Log::Level::Info;
+    logOptions.format = options.jsonLog ? Log::Format::Json : Log::Format::Text;
+    logOptions.allToStderr = !options.streamFormat.empty();
+    Log::start(logOptions);
+    m_quiet = options.verbosity < 0;
+
+    TraceExport traceExport;
+    if (parsed && !options.traceFile.empty()) {
+        Trace::setThreadName("main");
+        Trace::start();
+        traceExport.path = options.traceFile;
+    }
+    if (parsed && options.trackAllocations) {
+        AllocationTracker::start();
+    }
+
+    if (!m_quiet) {
+        CLIHandler::printWelcomeMessage();
+    }
+    if (!parsed) {
+        CLIHandler::printUsage(programPath.filename().string());
+        return 1; // 参数错误，打印用法并退出
+    }
+    if (options.showHelp) {
         CLIHandler::printUsage(programPath.filename().string());
         return 0; // 打印用法后正常退出
     }
-    // --- 结束核心修改 ---
+    if (options.mergeShards) {
+        return runMerge(options.inputPath); // 只合并已有的分片结果，不需要配置和字体
+    }
 
+    bool initialized;
+    {
+        TRACE_SPAN("initialize");
+        initialized = initialize();
+    }
+    if (!initialized) {
+        return 1; // 初始化失败，直接退出
+    }
 
-    CLIHandler::printEffectiveConfiguration(m_config);
+    if (!options.reportFile.empty() && (!options.streamFormat.empty() || !options.serveSocket.empty())) {
+        LOG_WARN << "Warning: --report only applies to image and batch runs; ignoring it.";
+    }
+    if ((options.progress || !options.statusFile.empty()) && (!options.streamFormat.empty() || !options.serveSocket.empty())) {
+        LOG_WARN << "Warning: --progress and --status-file only apply to batch runs; ignoring them.";
+    }
+    if (!options.streamFormat.empty()) {
+        return runStream(options.inputPath, options.streamFormat);
+    }
+
+    if (!options.serveSocket.empty()) {
+        printConfiguration();
+        JobServer server(m_config);
+        return server.run(options.serveSocket);
+    }
+
+    // 路径列表：标准输入或列表文件
+    std::ifstream listFile;
+    if (!options.filesFrom.empty() && options.filesFrom != "-") {
+        listFile.open(options.filesFrom, std::ios::binary);
+        if (!listFile) {
+            LOG_ERROR << "Error: Cannot open file list '" << options.filesFrom << "'.";
+            return 1;
+        }
+    }
+
+    printConfiguration();
 
     auto overall_start_time = high_resolution_clock::now();
 
     ProcessingOrchestrator orchestrator(m_config);
-    orchestrator.process(inputPathStr); // 使用从命令行获取的路径
+    orchestrator.setShard(options.shard);
+    std::string perfCountersError;
+    if (!options.reportFile.empty()) {
+        orchestrator.enableImageReports();
+        if (options.perfCounters && !PerfCounters::start(perfCountersError)) {
+            LOG_WARN << "Warning: Hardware performance counters are unavailable (" << perfCountersError << "); continuing without them.";
+        }
+    } else if (options.perfCounters) {
+        LOG_WARN << "Warning: --perf-counters only takes effect together with --report.";
+    }
+    std::unique_ptr<ProgressReporter> progress;
+    if (options.progress || !options.statusFile.empty()) {
+        // 终端上是原地刷新的状态行；输出被重定向或使用 JSON 日志时改为定期写一条日志
+        ProgressReporter::Options progressOptions;
+        progressOptions.statusLine = options.progress && !options.jsonLog && isStderrTerminal();
+        progressOptions.logLines = options.progress && !progressOptions.statusLine;
+        progressOptions.statusFile = options.statusFile;
+        progress = std::make_unique<ProgressReporter>(progressOptions);
+        orchestrator.setProgressReporter(progress.get());
+        progress->start();
+    }
+    if (options.filesFrom.empty()) {
+        orchestrator.process(options.inputPath); // 使用从命令行获取的路径
+    } else if (options.filesFrom == "-") {
+        orchestrator.processFileList(std::cin, options.nulSeparated, "stdin");
+    } else {
+        orchestrator.processFileList(listFile, options.nulSeparated, std::filesystem::path(options.filesFrom).stem().string());
+    }
+    if (progress) {
+        progress->stop();
+    }
 
     auto overall_end_time = high_resolution_clock::now();
     double total_duration = duration_cast<duration<double>>(overall_end_time - overall_start_time).count();
 
-    CLIHandler::printProcessingSummary(
-        orchestrator.getProcessedCount(),
-        orchestrator.getFailedCount(),
-        total_duration,
-        orchestrator.getFinalOutputDir()
-    );
+    if (!options.reportFile.empty()) {
+        RunReport report;
+        report.stats = orchestrator.getStats();
+        report.durationSeconds = total_duration;
+        report.workerThreads = orchestrator.getWorkerThreadCount();
+        report.images = orchestrator.takeImageReports();
+        report.perfCountersRequested = options.perfCounters;
+        report.perfCountersError = perfCountersError;
+        if (options.perfCounters && perfCountersError.empty()) {
+            report.perfCounters = PerfCounters::collect();
+        }
+        report.allocationsTracked = AllocationTracker::isEnabled();
+        if (report.allocationsTracked) {
+            report.totalAllocations = AllocationTracker::getTotalAllocations();
+            report.totalAllocatedBytes = AllocationTracker::getTotalBytes();
+            report.allocationStages = AllocationTracker::collect();
+        }
+        writeRunReport(options.reportFile, report);
+    }
+
+    printSummary(orchestrator.getStats(), total_duration, orchestrator.getFinalOutputDir());
 
     // 如果有任何文件处理失败，返回一个非零的退出码
     return (orchestrator.getFailedCount() > 0) ? 1 : 0;
 }
 
+int Application::runMerge(const std::filesystem::path& batchOutputDir) {
+    LOG_INFO << "\nMerging shard results in " << batchOutputDir.string() << "...";
+    ProcessingStats stats;
+    double wallSeconds = 0.0;
+    if (!mergeShardFragments(batchOutputDir, stats, wallSeconds)) {
+        LOG_ERROR << "Error: Failed to merge shard results.";
+        return 1;
+    }
+    printSummary(stats, wallSeconds, batchOutputDir);
+    return stats.failedCount > 0 ? 1 : 0;
+}
+
+int Application::runStream(const std::string& inputPath, const std::string& format) {
+    setBinaryStdio();
+
+    std::optional<AsciiConversionResult> conversion;
+    if (inputPath == "-") {
+        std::vector<unsigned char> inputBytes;
+        if (!readAllStdin(inputBytes) || inputBytes.empty()) {
+            LOG_ERROR << "Error: No image data could be read from stdin.";
+            return 1;
+        }
+        conversion = convertImageBytesToAscii(inputBytes.data(), inputBytes.size(), "stdin",
+                                              m_config.targetWidth, m_config.charAspectRatioCorrection);
+    } else if (isAsciiGridFile(inputPath)) {
+        conversion = loadAsciiGridFile(inputPath);
+    } else {
+        conversion = convertImageToAscii(inputPath, m_config.targetWidth, m_config.charAspectRatioCorrection);
+    }
+    if (!conversion) {
+        return 1; // 转换函数已打印原因
+    }
+
+    std::unique_ptr<IRenderer> renderer;
+    if (format == "png") {
+        renderer = std::make_unique<PngRenderer>();
+    } else if (format == "html") {
+        renderer = std::make_unique<HtmlRenderer>();
+    } else {
+        renderer = std::make_unique<SvgRenderer>();
+    }
+
+    // 只生成一个输出：使用配置中的第一个颜色方案
+    const ColorScheme scheme = m_config.schemesToGenerate.empty() ? ColorScheme::BLACK_ON_WHITE : m_config.schemesToGenerate.front();
+    FdSink sink(fileno(stdout), "stdout");
+    if (!renderer->render(conversion->data, sink, m_config, scheme) || !sink.finish()) {
+        return 1;
+    }
+    return 0;
+}
+
+void Application::printConfiguration() {
+    if (m_quiet) return;
+    Log::flush();
+    CLIHandler::printEffectiveConfiguration(m_config);
+}
+
+void Application::printSummary(const ProcessingStats& stats, double duration, const std::filesystem::path& outputDir) {
+    if (m_quiet) return;
+    Log::flush();
+    CLIHandler::printProcessingSummary(stats, duration, outputDir);
+    if (AllocationTracker::isEnabled()) {
+        CLIHandler::printAllocationSummary(AllocationTracker::collect(), AllocationTracker::getTotalAllocations(),
+                                           AllocationTracker::getTotalBytes());
+    }
+}
+
 bool Application::initialize() {
     std::filesystem::path exePath = PathManager::getExecutablePath(m_argc, m_argv);
     m_exeDir = exePath.parent_path();
@@ -67,7 +316,7 @@ bool Application::initialize() {
     std::filesystem::path configPathObj = m_exeDir / configFilename;
 
     if (!loadConfiguration(configPathObj, m_config)) {
-        std::cout << "Error: Configuration file could not be parsed correctly. Please check config.json. Proceeding with default values." << std::endl;
+        LOG_ERROR << "Error: Configuration file could not be parsed correctly. Please check config.json. Proceeding with default values.";
     }
     
     return resolveFontPath();
@@ -81,14 +330,14 @@ bool Application::resolveFontPath() {
         potentialFontPath = std::filesystem::current_path() / m_config.fontFilename;
         if (std::filesystem::exists(potentialFontPath) && std::filesystem::is_regular_file(potentialFontPath)) {
             m_config.finalFontPath = potentialFontPath.string();
-            std::cout << "Info: Font found in current working directory: " << m_config.finalFontPath << std::endl;
+            LOG_INFO << "Info: Font found in current working directory: " << m_config.finalFontPath;
         } else {
-            std::cerr << "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!" << std::endl;
-            std::cerr << "Error: Font file '" << m_config.fontFilename << "' not found!" << std::endl;
-            std::cerr << "Searched near executable: " << (m_exeDir / m_config.fontFilename).string() << std::endl;
-            std::cerr << "Searched in current dir: " << (std::filesystem::current_path() / m_config.fontFilename).string() << std::endl;
-            std::cerr << "Please ensure '" << m_config.fontFilename << "' is placed correctly or update config.json." << std::endl;
-            std::cerr << "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!" << std::endl;
+            LOG_ERROR << "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!";
+            LOG_ERROR << "Error: Font file '" << m_config.fontFilename << "' not found!";
+            LOG_ERROR << "Searched near executable: " << (m_exeDir / m_config.fontFilename).string();
+            LOG_ERROR << "Searched in current dir: " << (std::filesystem::current_path() / m_config.fontFilename).string();
+            LOG_ERROR << "Please ensure '" << m_config.fontFilename << "' is placed correctly or update config.json.";
+            LOG_ERROR << "!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!";
             return false;
         }
     }
@@ -11,11 +11,17 @@ public:
 private:
     bool initialize();
     bool resolveFontPath();
+    int runMerge(const std::filesystem::path& batchOutputDir);
+    int runStream(const std::string& inputPath, const std::string& format);
+    // -q 时不打印；打印前先写出排队中的日志，避免与之交错
+    void printConfiguration();
+    void printSummary(const ProcessingStats& stats, double duration, const std::filesystem::path& outputDir);
 
     int m_argc;
     char** m_argv;
     Config m_config;
     std::filesystem::path m_exeDir;
+    bool m_quiet = false;
 };
 
 #endif // APPLICATION_H
\ No newline at end of file
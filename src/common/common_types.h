@@ -26,6 +26,10 @@ const set<string> SUPPORTED_EXTENSIONS = {
     ".png", ".jpg", ".jpeg", ".bmp", ".tga", ".gif"
 };
 
+// Pre-converted ASCII grid (see conversion/ascii_grid_file.h), rendered without decoding
+const string ASCII_GRID_EXTENSION = ".agrid";
+const string TAR_ARCHIVE_EXTENSION = ".tar";
+
 // --- Enums ---
 enum class ColorScheme {
     AMBER_ON_BLACK, BLACK_ON_YELLOW, BLACK_ON_CYAN, COLOR_ON_WHITE,
@@ -60,6 +64,57 @@ struct Config {
     // HTML Output Settings
     bool generateHtmlOutput = true;
     float htmlFontSizePt = 8.0f;         // Font size for HTML output in points
+
+    // SVG Output Settings (uses fontSize in px, one <text> per row)
+    bool generateSvgOutput = false;
+
+    // Write the conversion grid as <stem>.agrid next to the outputs for render-only reruns
+    bool writeAsciiGrid = false;
+
+    // Content-addressed conversion cache (empty dir disables it)
+    string conversionCacheDir = "";
+    int conversionCacheMaxMB = 1024;
+
+    // Incremental batch mode: skip inputs recorded as unchanged in the batch manifest
+    bool incrementalBatch = false;
+
+    // Process byte-identical inputs once and hard-link (or copy) outputs for the duplicates
+    bool deduplicateInputs = false;
+
+    // Batch directory traversal
+    bool recursiveScan = false;              // Descend into subdirectories; outputs mirror the input tree
+    vector<string> includePatterns;          // Globs matched against the relative path; empty means all supported files
+    vector<string> excludePatterns;          // Globs for files and directories to skip
+    bool followSymlinks = false;             // Follow symlinked files and directories (loops are detected)
+    int workerThreads = 0;                   // Worker pool size, 0 = hardware concurrency
+    int prefetchBudgetMB = 256;              // Read-ahead budget for queued batch inputs, 0 = disabled
+
+    // Stream batch outputs into one tar archive (_outputs.tar) instead of one file per output
+    bool archiveBatchOutputs = false;
+};
+
+// Counters reported in the processing summary at the end of a run
+struct ProcessingStats {
+    int processedCount = 0;
+    int failedCount = 0;
+    int unchangedCount = 0; // Skipped by incremental batch mode
+    int duplicateCount = 0; // Byte-identical inputs whose outputs were linked
+    bool cacheEnabled = false;
+    int cacheHits = 0;
+    int cacheMisses = 0;
+};
+
+// Static partition of a batch across processes: this process handles the inputs
+// whose relative path hashes to `index` modulo `count`
+struct ShardSpec {
+    int index = 0;
+    int count = 1;
+
+    bool isSharded() const { return count > 1; }
+    // Inserted before the extension of per-shard files, e.g. "_manifest.shard-0-of-4.json"
+    string fileTag() const {
+        return isSharded() ? ".shard-" + std::to_string(index) + "-of-" + std::to_string(count) : "";
+    }
 };
 
 // --- Helper Functions (moved here for common use) ---
@@ -84,6 +139,16 @@ inline bool isImageFile(const path& p) {
     return SUPPORTED_EXTENSIONS.count(ext);
 }
 
+inline bool isAsciiGridFile(const path& p) {
+    if (!p.has_extension()) return false;
+    return toLower(p.extension().string()) == ASCII_GRID_EXTENSION;
+}
+
+inline bool isTarArchive(const path& p) {
+    if (!p.has_extension()) return false;
+    return toLower(p.extension().string()) == TAR_ARCHIVE_EXTENSION;
+}
+
 // Helper to read a file into a byte vector
 inline vector<unsigned char> readFileBytes(const string& filename) {
     std::ifstream file(filename, std::ios::binary | std::ios::ate);
@@ -1,5 +1,19 @@
 // src/common/stb_impl.cpp
 // 这个文件的唯一目的就是为 stb 库提供实现。
+// stb 的内存分配全部经过 BufferPool：解码和编码用的大缓冲在同一工作线程处理下一张图片时复用。
+
+#include "utils/BufferPool.h"
+
+#define STBI_MALLOC(sz)        BufferPool::allocate(sz)
+#define STBI_REALLOC(p, newsz) BufferPool::reallocate(p, newsz)
+#define STBI_FREE(p)           BufferPool::release(p)
+
+#define STBIW_MALLOC(sz)        BufferPool::allocate(sz)
+#define STBIW_REALLOC(p, newsz) BufferPool::reallocate(p, newsz)
+#define STBIW_FREE(p)           BufferPool::release(p)
+
+#define STBTT_malloc(x, u) ((void)(u), BufferPool::allocate(x))
+#define STBTT_free(x, u)   ((void)(u), BufferPool::release(x))
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
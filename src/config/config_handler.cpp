@@ -2,8 +2,8 @@
 // 专门负责读取和解析 config.json
 #include "config_handler.h"
 #include "common_types.h"
+#include "utils/Logger.h"
 #include <nlohmann/json.hpp> // 使用 nlohmann/json 库
-#include <iostream>
 #include <fstream>
 #include <iomanip>
 
@@ -40,11 +40,11 @@ const std::unordered_map<std::string, ColorScheme>& getColorSchemeMap() {
 // --- Public Functions ---
 
 bool loadConfiguration(const std::filesystem::path& configPath, Config& config) {
-    std::cout << "Info: Attempting to load configuration from '" << configPath.string() << "'..." << std::endl;
+    LOG_INFO << "Info: Attempting to load configuration from '" << configPath.string() << "'...";
 
     std::ifstream configFile(configPath);
     if (!configFile.is_open()) {
-        std::cout << "Info: Config file '" << configPath.string() << "' not found. Using default values." << std::endl;
+        LOG_INFO << "Info: Config file '" << configPath.string() << "' not found. Using default values.";
         return true; // 文件不存在是正常情况，使用默认配置
     }
 
@@ -69,6 +69,31 @@ bool loadConfiguration(const std::filesystem::path& configPath, Config& config)
         config.generateHtmlOutput = settings.value("generateHtmlOutput", config.generateHtmlOutput);
         config.htmlFontSizePt = settings.value("htmlFontSizePt", config.htmlFontSizePt);
 
+        // SVG 相关配置
+        config.generateSvgOutput = settings.value("generateSvgOutput", config.generateSvgOutput);
+
+        // ASCII 网格缓存文件
+        config.writeAsciiGrid = settings.value("writeAsciiGrid", config.writeAsciiGrid);
+
+        // 转换缓存
+        config.conversionCacheDir = settings.value("conversionCacheDir", config.conversionCacheDir);
+        config.conversionCacheMaxMB = settings.value("conversionCacheMaxMB", config.conversionCacheMaxMB);
+
+        // 增量批处理
+        config.incrementalBatch = settings.value("incrementalBatch", config.incrementalBatch);
+        config.deduplicateInputs = settings.value("deduplicateInputs", config.deduplicateInputs);
+
+        // 目录遍历
+        config.recursiveScan = settings.value("recursiveScan", config.recursiveScan);
+        config.includePatterns = settings.value("includePatterns", config.includePatterns);
+        config.excludePatterns = settings.value("excludePatterns", config.excludePatterns);
+        config.followSymlinks = settings.value("followSymlinks", config.followSymlinks);
+        config.workerThreads = settings.value("workerThreads", config.workerThreads);
+        config.prefetchBudgetMB = settings.value("prefetchBudgetMB", config.prefetchBudgetMB);
+
+        // 批处理输出归档
+        config.archiveBatchOutputs = settings.value("archiveBatchOutputs", config.archiveBatchOutputs);
+
         // 处理颜色方案数组
         if (settings.contains("colorSchemes") && settings["colorSchemes"].is_array()) {
             config.schemesToGenerate.clear();
@@ -81,7 +106,7 @@ bool loadConfiguration(const std::filesystem::path& configPath, Config& config)
                     if (it != map.end()) {
                         config.schemesToGenerate.push_back(it->second);
                     } else {
-                        std::cerr << "Warning: Unknown color scheme name in config: '" << schemeNameStr << "'. Ignoring." << std::endl;
+                        LOG_WARN << "Warning: Unknown color scheme name in config: '" << schemeNameStr << "'. Ignoring.";
                     }
                 }
             }
@@ -89,23 +114,23 @@ bool loadConfiguration(const std::filesystem::path& configPath, Config& config)
 
         // 如果加载后列表为空，则恢复默认值
         if (config.schemesToGenerate.empty()) {
-            std::cerr << "Warning: No valid color schemes found in config. Reverting to defaults." << std::endl;
+            LOG_WARN << "Warning: No valid color schemes found in config. Reverting to defaults.";
             config.schemesToGenerate = { ColorScheme::BLACK_ON_WHITE, ColorScheme::COLOR_ON_WHITE };
         }
 
     } catch (const json::parse_error& e) {
         // 捕获 JSON 解析错误
-        std::cerr << "Error: Failed to parse config file '" << configPath.string() << "'." << std::endl;
-        std::cerr << "       Reason: " << e.what() << std::endl;
-        std::cerr << "       Using default values instead." << std::endl;
+        LOG_ERROR << "Error: Failed to parse config file '" << configPath.string() << "'.";
+        LOG_ERROR << "       Reason: " << e.what();
+        LOG_ERROR << "       Using default values instead.";
         return false;
     } catch (const std::exception& e) {
         // 捕获其他可能的异常
-        std::cerr << "An unexpected error occurred while reading config: " << e.what() << std::endl;
+        LOG_ERROR << "An unexpected error occurred while reading config: " << e.what();
         return false;
     }
 
-    std::cout << "Info: Configuration loaded successfully." << std::endl;
+    LOG_INFO << "Info: Configuration loaded successfully.";
     return true;
 }
 
@@ -114,11 +139,11 @@ bool loadConfiguration(const std::filesystem::path& configPath, Config& config)
 bool writeConfigToFile(const Config& config, const std::filesystem::path& outputFilePath) {
     std::ofstream configFile(outputFilePath);
     if (!configFile.is_open()) {
-        std::cerr << "Error: Could not open config output file for writing: " << outputFilePath.string() << std::endl;
+        LOG_ERROR << "Error: Could not open config output file for writing: " << outputFilePath.string();
         return false;
     }
 
-    std::cout << "Info: Writing effective configuration to: " << outputFilePath.string() << std::endl;
+    LOG_INFO << "Info: Writing effective configuration to: " << outputFilePath.string();
 
     configFile << "# Effective configuration used for this run" << std::endl;
     configFile << "# Automatically generated by the program." << std::endl;
@@ -139,6 +164,29 @@ bool writeConfigToFile(const Config& config, const std::filesystem::path& output
     configFile << "generateHtmlOutput = " << (config.generateHtmlOutput ? "true" : "false") << std::endl;
     configFile << "htmlFontSizePt = " << std::fixed << std::setprecision(2) << config.htmlFontSizePt << " # Font size for HTML output in points" << std::endl;
 
+    // SVG Settings
+    configFile << "generateSvgOutput = " << (config.generateSvgOutput ? "true" : "false") << std::endl;
+    configFile << "writeAsciiGrid = " << (config.writeAsciiGrid ? "true" : "false") << " # Save .agrid files for render-only reruns" << std::endl;
+    configFile << "conversionCacheDir = " << config.conversionCacheDir << "  # Empty means disabled" << std::endl;
+    configFile << "conversionCacheMaxMB = " << config.conversionCacheMaxMB << std::endl;
+    configFile << "incrementalBatch = " << (config.incrementalBatch ? "true" : "false") << " # Skip inputs unchanged since the last run" << std::endl;
+    configFile << "deduplicateInputs = " << (config.deduplicateInputs ? "true" : "false") << " # Link outputs for byte-identical inputs" << std::endl;
+    configFile << "recursiveScan = " << (config.recursiveScan ? "true" : "false") << std::endl;
+    configFile << "includePatterns = ";
+    for (size_t i = 0; i < config.includePatterns.size(); ++i) {
+        configFile << (i > 0 ? ", " : "") << config.includePatterns[i];
+    }
+    configFile << std::endl;
+    configFile << "excludePatterns = ";
+    for (size_t i = 0; i < config.excludePatterns.size(); ++i) {
+        configFile << (i > 0 ? ", " : "") << config.excludePatterns[i];
+    }
+    configFile << std::endl;
+    configFile << "followSymlinks = " << (config.followSymlinks ? "true" : "false") << std::endl;
+    configFile << "workerThreads = " << config.workerThreads << "  # 0 = hardware concurrency" << std::endl;
+    configFile << "prefetchBudgetMB = " << config.prefetchBudgetMB << "  # 0 = no read-ahead" << std::endl;
+    configFile << "archiveBatchOutputs = " << (config.archiveBatchOutputs ? "true" : "false") << " # Write batch outputs into _outputs.tar" << std::endl;
+
 
     configFile << "colorSchemes = ";
     if (config.schemesToGenerate.empty()) {
@@ -155,7 +203,7 @@ bool writeConfigToFile(const Config& config, const std::filesystem::path& output
 
     configFile.close();
     if (!configFile) {
-         std::cerr << "Error: Failed to write all data or close the config output file: " << outputFilePath.string() << std::endl;
+         LOG_ERROR << "Error: Failed to write all data or close the config output file: " << outputFilePath.string();
          return false;
     }
 
@@ -0,0 +1,187 @@
+// ascii_grid_file.cpp
+
+#include "ascii_grid_file.h"
+#include "utils/MappedFile.h"
+#include "utils/Logger.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace { // Anonymous namespace for internal helpers
+
+const char GRID_MAGIC[4] = {'A', 'G', 'R', 'D'};
+const size_t GRID_FIXED_HEADER_SIZE = 36;
+
+void putU16(std::vector<unsigned char>& out, size_t offset, uint16_t v) {
+    out[offset] = static_cast<unsigned char>(v & 0xFF);
+    out[offset + 1] = static_cast<unsigned char>(v >> 8);
+}
+
+void putU32(std::vector<unsigned char>& out, size_t offset, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out[offset + i] = static_cast<unsigned char>((v >> (8 * i)) & 0xFF);
+}
+
+void putU64(std::vector<unsigned char>& out, size_t offset, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out[offset + i] = static_cast<unsigned char>((v >> (8 * i)) & 0xFF);
+}
+
+uint16_t getU16(const unsigned char* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t getU32(const unsigned char* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+uint64_t getU64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+} // end anonymous namespace
+
+bool serializeAsciiGrid(const AsciiConversionResult& result, std::vector<unsigned char>& buffer) {
+    if (result.data.empty() || result.data[0].empty()) {
+        LOG_ERROR << "Error: Cannot serialize an empty ASCII grid.";
+        return false;
+    }
+
+    const size_t width = result.data[0].size();
+    const size_t height = result.data.size();
+    const size_t cells = width * height;
+    const size_t headerSize = GRID_FIXED_HEADER_SIZE + ASCII_CHARS.size();
+
+    buffer.assign(headerSize + cells * 4, 0);
+    std::memcpy(buffer.data(), GRID_MAGIC, sizeof(GRID_MAGIC));
+    putU16(buffer, 4, ASCII_GRID_FORMAT_VERSION);
+    putU16(buffer, 6, static_cast<uint16_t>(headerSize));
+    putU32(buffer, 8, static_cast<uint32_t>(width));
+    putU32(buffer, 12, static_cast<uint32_t>(height));
+    putU32(buffer, 16, static_cast<uint32_t>(result.originalWidth));
+    putU32(buffer, 20, static_cast<uint32_t>(result.originalHeight));
+    putU64(buffer, 24, result.sourceHash);
+    putU16(buffer, 32, static_cast<uint16_t>(ASCII_CHARS.size()));
+    std::memcpy(buffer.data() + GRID_FIXED_HEADER_SIZE, ASCII_CHARS.data(), ASCII_CHARS.size());
+
+    // 字符到字形索引的查找表；-1 表示字符不在字符表中
+    int glyphIndex[256];
+    std::fill(std::begin(glyphIndex), std::end(glyphIndex), -1);
+    for (size_t i = 0; i < ASCII_CHARS.size(); ++i) {
+        glyphIndex[static_cast<unsigned char>(ASCII_CHARS[i])] = static_cast<int>(i);
+    }
+
+    unsigned char* glyphPlane = buffer.data() + headerSize;
+    unsigned char* rgbPlane = glyphPlane + cells;
+    for (const auto& lineData : result.data) {
+        if (lineData.size() != width) {
+            LOG_ERROR << "Error: Ragged ASCII grid rows; cannot serialize the grid.";
+            return false;
+        }
+        for (const auto& charInfo : lineData) {
+            const int index = glyphIndex[static_cast<unsigned char>(charInfo.character)];
+            if (index < 0) {
+                // 格式只能存字符表中的字形，静默映射成索引 0 会把字符悄悄换成 '@'
+                LOG_ERROR << "Error: Character code " << (static_cast<unsigned>(charInfo.character) & 0xFF)
+                          << " is not in the glyph ramp; cannot serialize the grid.";
+                return false;
+            }
+            *glyphPlane++ = static_cast<unsigned char>(index);
+            *rgbPlane++ = charInfo.color[0];
+            *rgbPlane++ = charInfo.color[1];
+            *rgbPlane++ = charInfo.color[2];
+        }
+    }
+
+    return true;
+}
+
+bool writeAsciiGridFile(const AsciiConversionResult& result, const std::filesystem::path& outputPath) {
+    // 整个文件先在内存中组装，然后一次性写出
+    std::vector<unsigned char> buffer;
+    if (!serializeAsciiGrid(result, buffer)) {
+        LOG_ERROR << "Error: Cannot write ASCII grid to '" << outputPath.string() << "'.";
+        return false;
+    }
+
+    std::ofstream gridFile(outputPath, std::ios::binary);
+    if (!gridFile.is_open()) {
+        LOG_ERROR << "Error: Failed to open ASCII grid file for writing: " << outputPath.string();
+        return false;
+    }
+    gridFile.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    gridFile.close();
+    if (!gridFile) {
+        LOG_ERROR << "Error: Failed to write ASCII grid file: " << outputPath.string();
+        return false;
+    }
+    return true;
+}
+
+std::optional<AsciiConversionResult> loadAsciiGridFile(const std::filesystem::path& gridPath) {
+    MappedFile mapped;
+    if (!mapped.open(gridPath)) {
+        return std::nullopt;
+    }
+
+    const unsigned char* p = mapped.data();
+    const size_t fileSize = mapped.size();
+    if (fileSize < GRID_FIXED_HEADER_SIZE || std::memcmp(p, GRID_MAGIC, sizeof(GRID_MAGIC)) != 0) {
+        LOG_ERROR << "Error: '" << gridPath.string() << "' is not an ASCII grid file.";
+        return std::nullopt;
+    }
+    uint16_t version = getU16(p + 4);
+    if (version != ASCII_GRID_FORMAT_VERSION) {
+        LOG_ERROR << "Error: Unsupported ASCII grid version " << version << " in '" << gridPath.string() << "'.";
+        return std::nullopt;
+    }
+
+    const size_t headerSize = getU16(p + 6);
+    const size_t width = getU32(p + 8);
+    const size_t height = getU32(p + 12);
+    const uint32_t originalWidth = getU32(p + 16);
+    const uint32_t originalHeight = getU32(p + 20);
+    const size_t rampLength = getU16(p + 32);
+    // 尺寸字段不可信（缓存文件也走这里）：先确认 宽*高 不会溢出，再用除法与文件长度比较，
+    // 避免乘积回绕后通过长度检查
+    if (width == 0 || height == 0 || width > INT_MAX || height > INT_MAX || originalWidth > INT_MAX ||
+        originalHeight > INT_MAX || rampLength == 0 || headerSize < GRID_FIXED_HEADER_SIZE + rampLength ||
+        headerSize > fileSize || (fileSize - headerSize) % 4 != 0 || width > SIZE_MAX / height ||
+        (fileSize - headerSize) / 4 != width * height) {
+        LOG_ERROR << "Error: Corrupted ASCII grid header in '" << gridPath.string() << "'.";
+        return std::nullopt;
+    }
+    const size_t cells = width * height;
+
+    const unsigned char* ramp = p + GRID_FIXED_HEADER_SIZE;
+    const unsigned char* glyphPlane = p + headerSize;
+    const unsigned char* rgbPlane = glyphPlane + cells;
+
+    AsciiConversionResult result;
+    result.originalWidth = static_cast<int>(originalWidth);
+    result.originalHeight = static_cast<int>(originalHeight);
+    result.sourceHash = getU64(p + 24);
+    result.asciiWidth = static_cast<int>(width);
+    result.asciiHeight = static_cast<int>(height);
+    result.data.resize(height);
+
+    for (auto& lineData : result.data) {
+        lineData.resize(width);
+        for (auto& charInfo : lineData) {
+            unsigned char index = *glyphPlane++;
+            if (index >= rampLength) {
+                LOG_ERROR << "Error: Glyph index out of range in '" << gridPath.string() << "'.";
+                return std::nullopt;
+            }
+            charInfo.character = static_cast<char>(ramp[index]);
+            charInfo.color[0] = *rgbPlane++;
+            charInfo.color[1] = *rgbPlane++;
+            charInfo.color[2] = *rgbPlane++;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,36 @@
+// ascii_grid_file.h
+#ifndef ASCII_GRID_FILE_H
+#define ASCII_GRID_FILE_H
+
+#include "image_converter.h"
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+// .agrid 二进制格式（小端序，版本 1）：
+//   偏移  0  char[4]  魔数 "AGRD"
+//   偏移  4  u16      格式版本
+//   偏移  6  u16      头部长度（含字符表），即字形平面的起始偏移
+//   偏移  8  u32      ASCII 宽度（列）
+//   偏移 12  u32      ASCII 高度（行）
+//   偏移 16  u32      原图宽度
+//   偏移 20  u32      原图高度
+//   偏移 24  u64      源文件内容哈希（ContentHash，未知时为 0）
+//   偏移 32  u16      字符表长度 N
+//   偏移 34  u16      保留
+//   偏移 36  char[N]  字符表（例如 ASCII_CHARS）
+//   之后依次为：字形索引平面 (宽*高 字节，按行存放)、RGB 平面 (宽*高*3 字节)
+const uint16_t ASCII_GRID_FORMAT_VERSION = 1;
+
+// 将转换结果按 .agrid 格式组装到内存中。成功返回 true。
+bool serializeAsciiGrid(const AsciiConversionResult& result, std::vector<unsigned char>& buffer);
+
+// 将转换结果写为 .agrid 文件。成功返回 true。
+bool writeAsciiGridFile(const AsciiConversionResult& result, const std::filesystem::path& outputPath);
+
+// 通过内存映射读取 .agrid 文件，跳过图像解码与转换。
+// 文件不存在、损坏或版本不兼容时返回 nullopt。
+std::optional<AsciiConversionResult> loadAsciiGridFile(const std::filesystem::path& gridPath);
+
+#endif // ASCII_GRID_FILE_H
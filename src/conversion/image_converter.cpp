@@ -1,10 +1,14 @@
 // image_converter.cpp
 
 #include "image_converter.h"
-#include <iostream>
+#include "utils/MappedFile.h"
+#include "utils/Logger.h"
+#include "utils/Trace.h"
+#include "utils/PerfCounters.h"
 #include <memory> // For unique_ptr
 #include <cmath>
 #include <algorithm> // For std::max, std::min
+#include <limits>
 
 
 // --- STB IMPLEMENTATION ---
@@ -14,13 +18,42 @@
 
 namespace { // Use an anonymous namespace for internal helper functions
 
-// Loads an image using stb_image
-// Returns a unique_ptr to the data, and sets width/height.
-// Returns nullptr on failure.
-std::unique_ptr<unsigned char, void(*)(void*)> loadImage(const std::string& imagePath, int& width, int& height) {
-    unsigned char *data = stbi_load(imagePath.c_str(), &width, &height, nullptr, OUTPUT_CHANNELS);
+// Decodes an already-loaded encoded image (PNG/JPG/...) from memory.
+std::unique_ptr<unsigned char, void(*)(void*)> loadImageFromMemory(const unsigned char* bytes, size_t length, const std::string& displayName, int& width, int& height) {
+    TRACE_SPAN("decode");
+    PERF_SCOPE("decode");
+    unsigned char *data = nullptr;
+    if (length > 0 && length <= static_cast<size_t>(std::numeric_limits<int>::max())) {
+        data = stbi_load_from_memory(bytes, static_cast<int>(length), &width, &height, nullptr, OUTPUT_CHANNELS);
+    }
     if (data == nullptr) {
-        std::cerr << "Error: Failed to load image '" << imagePath << "'. Reason: " << stbi_failure_reason() << std::endl;
+        LOG_ERROR << "Error: Failed to decode image '" << displayName << "'. Reason: " << (length > 0 ? stbi_failure_reason() : "empty input");
+        return std::unique_ptr<unsigned char, void(*)(void*)>(nullptr, stbi_image_free);
+    }
+    return std::unique_ptr<unsigned char, void(*)(void*)>(data, stbi_image_free);
+}
+
+// Loads an image file: regular files are memory-mapped and decoded in place, without
+// copying them through stdio buffers. Anything else (FIFOs, devices) goes through stbi_load.
+// Returns a unique_ptr to the data, and sets width/height. Returns nullptr on failure.
+std::unique_ptr<unsigned char, void(*)(void*)> loadImage(const std::filesystem::path& imagePath, int& width, int& height) {
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(imagePath, ec)) {
+        MappedFile mapped;
+        bool opened;
+        {
+            TRACE_SPAN("load");
+            opened = mapped.open(imagePath, MappedFile::Access::Sequential);
+        }
+        if (!opened) {
+            return std::unique_ptr<unsigned char, void(*)(void*)>(nullptr, stbi_image_free);
+        }
+        return loadImageFromMemory(mapped.data(), mapped.size(), imagePath.string(), width, height);
+    }
+    TRACE_SPAN("load+decode");
+    unsigned char *data = stbi_load(imagePath.string().c_str(), &width, &height, nullptr, OUTPUT_CHANNELS);
+    if (data == nullptr) {
+        LOG_ERROR << "Error: Failed to load image '" << imagePath.string() << "'. Reason: " << stbi_failure_reason();
         return std::unique_ptr<unsigned char, void(*)(void*)>(nullptr, stbi_image_free);
     }
     return std::unique_ptr<unsigned char, void(*)(void*)>(data, stbi_image_free);
@@ -30,7 +63,7 @@ std::unique_ptr<unsigned char, void(*)(void*)> loadImage(const std::string& imag
 vector<vector<CharColorInfo>> generateAsciiData(const unsigned char* imgData, int width, int height, int targetWidth, int targetHeight) {
     vector<vector<CharColorInfo>> asciiResultData;
     if (!imgData || width <= 0 || height <= 0 || targetWidth <= 0 || targetHeight <= 0) {
-        std::cerr << "Error: Invalid arguments to generateAsciiData." << std::endl;
+        LOG_ERROR << "Error: Invalid arguments to generateAsciiData.";
         return asciiResultData; // Return empty vector
     }
 
@@ -72,37 +105,28 @@ vector<vector<CharColorInfo>> generateAsciiData(const unsigned char* imgData, in
     return asciiResultData;
 }
 
-} // end anonymous namespace
-
-// --- Public Function Implementation ---
-
-std::optional<AsciiConversionResult> convertImageToAscii(
-    const std::filesystem::path& imagePath,
+// Shared tail of both public entry points: grid sizing and ASCII generation from decoded pixels
+std::optional<AsciiConversionResult> convertDecodedImage(
+    const unsigned char* imgData, int width, int height,
+    const std::string& displayName,
     int targetAsciiWidth,
     double aspectRatioCorrection)
 {
-    std::cout << "Loading image " << imagePath.filename().string() << "..." << std::endl;
-    int width, height;
-    auto imgDataPtr = loadImage(imagePath.string(), width, height);
-
-    if (!imgDataPtr) {
-        return std::nullopt; // Failed to load image
-    }
-     std::cout << "-> Loaded (" << width << "x" << height << ")" << std::endl;
+    LOG_DEBUG << "-> Loaded (" << width << "x" << height << ")";
 
-
-    std::cout << "Generating ASCII data..." << std::endl;
+    LOG_DEBUG << "Generating ASCII data...";
     // Calculate target height based on width and aspect ratio correction
     int targetAsciiHeight = static_cast<int>(std::round(static_cast<double>(height * targetAsciiWidth) / (width * aspectRatioCorrection)));
     targetAsciiHeight = std::max(1, targetAsciiHeight); // Ensure at least 1 row
-     std::cout << "Calculated ASCII grid: " << targetAsciiWidth << "x" << targetAsciiHeight << std::endl;
-
+    LOG_DEBUG << "Calculated ASCII grid: " << targetAsciiWidth << "x" << targetAsciiHeight;
 
+    TRACE_SPAN("convert");
+    PERF_SCOPE("convert");
     vector<vector<CharColorInfo>> asciiData = generateAsciiData(
-        imgDataPtr.get(), width, height, targetAsciiWidth, targetAsciiHeight);
+        imgData, width, height, targetAsciiWidth, targetAsciiHeight);
 
     if (asciiData.empty() || asciiData[0].empty()) {
-        std::cerr << "Error: Failed to generate ASCII data for " << imagePath.filename().string() << "." << std::endl;
+        LOG_ERROR << "Error: Failed to generate ASCII data for " << displayName << ".";
         return std::nullopt;
     }
 
@@ -114,4 +138,75 @@ std::optional<AsciiConversionResult> convertImageToAscii(
     result.asciiHeight = targetAsciiHeight;
 
     return result;
-}
\ No newline at end of file
+}
+
+} // end anonymous namespace
+
+// --- Public Function Implementation ---
+
+std::optional<AsciiConversionResult> convertImageToAscii(
+    const std::filesystem::path& imagePath,
+    int targetAsciiWidth,
+    double aspectRatioCorrection)
+{
+    LOG_DEBUG << "Loading image " << imagePath.filename().string() << "...";
+    int width, height;
+    auto imgDataPtr = loadImage(imagePath, width, height);
+
+    if (!imgDataPtr) {
+        return std::nullopt; // Failed to load image
+    }
+    return convertDecodedImage(imgDataPtr.get(), width, height, imagePath.filename().string(),
+                               targetAsciiWidth, aspectRatioCorrection);
+}
+
+std::optional<AsciiConversionResult> convertImageBytesToAscii(
+    const unsigned char* encodedBytes,
+    size_t encodedLength,
+    const std::string& displayName,
+    int targetAsciiWidth,
+    double aspectRatioCorrection)
+{
+    LOG_DEBUG << "Decoding image " << displayName << "...";
+    int width, height;
+    auto imgDataPtr = loadImageFromMemory(encodedBytes, encodedLength, displayName, width, height);
+
+    if (!imgDataPtr) {
+        return std::nullopt; // Failed to decode image
+    }
+    return convertDecodedImage(imgDataPtr.get(), width, height, displayName,
+                               targetAsciiWidth, aspectRatioCorrection);
+}
+
+std::optional<AsciiConversionResult> convertPixelsToAscii(
+    const unsigned char* pixels,
+    int width,
+    int height,
+    int channels,
+    int targetAsciiWidth,
+    double aspectRatioCorrection)
+{
+    if (!pixels || width <= 0 || height <= 0 || channels < 1 || channels > 4) {
+        LOG_ERROR << "Error: Invalid pixel buffer (" << width << "x" << height << ", " << channels << " channel(s)).";
+        return std::nullopt;
+    }
+    if (channels == OUTPUT_CHANNELS) {
+        return convertDecodedImage(pixels, width, height, "pixel buffer", targetAsciiWidth, aspectRatioCorrection);
+    }
+
+    // 统一展开为 RGB，与 stbi_load 返回的布局一致
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    vector<unsigned char> rgb(pixelCount * OUTPUT_CHANNELS);
+    for (size_t i = 0; i < pixelCount; ++i) {
+        const unsigned char* src = pixels + i * channels;
+        unsigned char* dst = rgb.data() + i * OUTPUT_CHANNELS;
+        if (channels <= 2) {
+            dst[0] = dst[1] = dst[2] = src[0];
+        } else {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+        }
+    }
+    return convertDecodedImage(rgb.data(), width, height, "pixel buffer", targetAsciiWidth, aspectRatioCorrection);
+}
@@ -5,6 +5,7 @@
 #include "common_types.h" // Includes vector, string, CharColorInfo, path etc.
 #include <filesystem>
 #include <optional> // To return result or indicate error
+#include <cstdint>
 
 struct AsciiConversionResult {
     vector<vector<CharColorInfo>> data;
@@ -12,6 +13,7 @@ struct AsciiConversionResult {
     int originalHeight = 0;
     int asciiWidth = 0;
     int asciiHeight = 0;
+    uint64_t sourceHash = 0; // ContentHash of the source file bytes, 0 if unknown
 };
 
 // Converts an image file to its ASCII representation.
@@ -23,4 +25,25 @@ std::optional<AsciiConversionResult> convertImageToAscii(
     double aspectRatioCorrection
 );
 
+// Same as convertImageToAscii, but decodes an encoded image that is already in memory
+// (e.g. read once for hashing). displayName is only used in log messages.
+std::optional<AsciiConversionResult> convertImageBytesToAscii(
+    const unsigned char* encodedBytes,
+    size_t encodedLength,
+    const std::string& displayName,
+    int targetAsciiWidth,
+    double aspectRatioCorrection
+);
+
+// Converts raw, tightly packed 8-bit pixels that are already decoded
+// (channels: 1 = gray, 2 = gray+alpha, 3 = RGB, 4 = RGBA; alpha is ignored).
+std::optional<AsciiConversionResult> convertPixelsToAscii(
+    const unsigned char* pixels,
+    int width,
+    int height,
+    int channels,
+    int targetAsciiWidth,
+    double aspectRatioCorrection
+);
+
 #endif // IMAGE_CONVERTER_H
\ No newline at end of file
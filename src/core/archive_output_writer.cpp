@@ -0,0 +1,123 @@
+#include "archive_output_writer.h"
+#include <chrono>
+
+ArchiveOutputWriter::ArchiveOutputWriter(const std::filesystem::path& archivePath, const std::filesystem::path& entryRoot,
+                                         size_t maxQueuedBytes)
+    : m_archivePath(archivePath),
+      m_entryRoot(entryRoot),
+      m_maxQueuedBytes(maxQueuedBytes),
+      m_mtime(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count()) {
+    m_open = m_tar.open(archivePath);
+    if (m_open) {
+        m_writer = std::thread(&ArchiveOutputWriter::writerLoop, this);
+    }
+}
+
+ArchiveOutputWriter::~ArchiveOutputWriter() {
+    finish();
+}
+
+std::string ArchiveOutputWriter::entryName(const std::filesystem::path& outputPath) const {
+    return outputPath.lexically_relative(m_entryRoot).generic_string();
+}
+
+bool ArchiveOutputWriter::add(const std::filesystem::path& outputPath, std::vector<unsigned char>&& data) {
+    Item item;
+    item.name = entryName(outputPath);
+    item.data = std::move(data);
+    return enqueue(std::move(item));
+}
+
+bool ArchiveOutputWriter::addLink(const std::filesystem::path& outputPath, const std::filesystem::path& existingOutputPath) {
+    Item item;
+    item.name = entryName(outputPath);
+    item.linkTarget = entryName(existingOutputPath);
+    return enqueue(std::move(item));
+}
+
+bool ArchiveOutputWriter::enqueue(Item&& item) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_open || m_closing || m_failed) {
+        return false;
+    }
+    // 单个条目超过上限时也要放行，否则会永远等待
+    m_spaceAvailable.wait(lock, [this] { return m_failed || m_queue.empty() || m_queuedBytes < m_maxQueuedBytes; });
+    if (m_failed) {
+        return false;
+    }
+    m_queuedBytes += item.data.size();
+    m_queue.push_back(std::move(item));
+    m_itemAvailable.notify_one();
+    return true;
+}
+
+void ArchiveOutputWriter::writerLoop() {
+    while (true) {
+        Item item;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_itemAvailable.wait(lock, [this] { return m_closing || !m_queue.empty(); });
+            if (m_queue.empty()) {
+                return; // m_closing 且已写完
+            }
+            item = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        const bool written = item.linkTarget.empty()
+            ? m_tar.addFile(item.name, item.data.data(), item.data.size(), m_mtime)
+            : m_tar.addHardLink(item.name, item.linkTarget, m_mtime);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queuedBytes -= item.data.size();
+        if (!written) {
+            m_failed = true;
+            m_queue.clear();
+            m_queuedBytes = 0;
+        }
+        m_spaceAvailable.notify_all();
+    }
+}
+
+bool ArchiveOutputWriter::finish() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_finished) {
+            return !m_failed;
+        }
+        m_finished = true;
+        m_closing = true;
+    }
+    m_itemAvailable.notify_all();
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
+    if (m_open && !m_tar.close()) {
+        m_failed = true;
+    }
+    return m_open && !m_failed;
+}
+
+// --- ArchiveEntrySink ---
+
+bool ArchiveEntrySink::write(const void* data, size_t size) {
+    if (m_failed || m_finished) return false;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    m_data.insert(m_data.end(), bytes, bytes + size);
+    m_bytesWritten += size;
+    return true;
+}
+
+bool ArchiveEntrySink::finish() {
+    if (m_failed) return false;
+    if (m_finished) return true;
+    m_finished = true;
+    if (!m_writer.add(m_outputPath, std::move(m_data))) {
+        m_failed = true;
+    }
+    return !m_failed;
+}
+
+std::string ArchiveEntrySink::describe() const {
+    return m_writer.getArchivePath().string() + ":" + m_outputPath.filename().string();
+}
@@ -0,0 +1,93 @@
+#ifndef ARCHIVE_OUTPUT_WRITER_H
+#define ARCHIVE_OUTPUT_WRITER_H
+
+#include "rendering/OutputSink.h"
+#include "utils/TarWriter.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 把批处理输出写入单个 tar 归档。工作线程在内存中生成输出后调用 add()，
+// 由一个专用写线程按提交顺序顺序写出，归档内的条目名为输出相对于 entryRoot 的路径
+// （与写成普通文件时的目录布局一致）。排队的字节数有上限，写盘跟不上时 add() 阻塞。
+class ArchiveOutputWriter {
+public:
+    static constexpr size_t DEFAULT_MAX_QUEUED_BYTES = 64 * 1024 * 1024;
+
+    ArchiveOutputWriter(const std::filesystem::path& archivePath, const std::filesystem::path& entryRoot,
+                        size_t maxQueuedBytes = DEFAULT_MAX_QUEUED_BYTES);
+    ~ArchiveOutputWriter(); // 未调用 finish() 时也会写完已排队的条目
+
+    ArchiveOutputWriter(const ArchiveOutputWriter&) = delete;
+    ArchiveOutputWriter& operator=(const ArchiveOutputWriter&) = delete;
+
+    bool isOpen() const { return m_open; }
+    const std::filesystem::path& getArchivePath() const { return m_archivePath; }
+
+    // 写线程已出错时返回 false
+    bool add(const std::filesystem::path& outputPath, std::vector<unsigned char>&& data);
+    // existingOutputPath 必须已经通过 add() 提交
+    bool addLink(const std::filesystem::path& outputPath, const std::filesystem::path& existingOutputPath);
+
+    // 写完所有排队的条目并关闭归档，之后不能再添加
+    bool finish();
+
+private:
+    struct Item {
+        std::string name;
+        std::string linkTarget; // 非空表示硬链接条目
+        std::vector<unsigned char> data;
+    };
+
+    bool enqueue(Item&& item);
+    void writerLoop();
+    std::string entryName(const std::filesystem::path& outputPath) const;
+
+    std::filesystem::path m_archivePath;
+    std::filesystem::path m_entryRoot;
+    size_t m_maxQueuedBytes;
+    int64_t m_mtime; // 所有条目使用运行开始的时间
+    TarWriter m_tar;
+    bool m_open = false;
+
+    std::mutex m_mutex;
+    std::condition_variable m_itemAvailable;
+    std::condition_variable m_spaceAvailable;
+    std::deque<Item> m_queue;
+    size_t m_queuedBytes = 0;
+    bool m_closing = false;
+    bool m_failed = false;
+    bool m_finished = false;
+    std::thread m_writer;
+};
+
+// 归档中的一个条目。tar 头部需要事先知道条目大小，且多个工作线程共用同一个归档，
+// 因此内容先在 sink 内缓冲，finish() 时整体交给 ArchiveOutputWriter 排队写出。
+class ArchiveEntrySink : public OutputSink {
+public:
+    ArchiveEntrySink(ArchiveOutputWriter& writer, std::filesystem::path outputPath)
+        : m_writer(writer), m_outputPath(std::move(outputPath)) {}
+
+    ArchiveEntrySink(const ArchiveEntrySink&) = delete;
+    ArchiveEntrySink& operator=(const ArchiveEntrySink&) = delete;
+
+    bool write(const void* data, size_t size) override;
+    bool finish() override;
+    std::string describe() const override;
+
+    uint64_t bytesWritten() const { return m_bytesWritten; }
+
+private:
+    ArchiveOutputWriter& m_writer;
+    std::filesystem::path m_outputPath;
+    std::vector<unsigned char> m_data;
+    uint64_t m_bytesWritten = 0;
+    bool m_finished = false;
+};
+
+#endif // ARCHIVE_OUTPUT_WRITER_H
@@ -0,0 +1,163 @@
+#include "batch_manifest.h"
+#include "config/config_handler.h"
+#include "utils/ContentHash.h"
+#include "utils/Logger.h"
+
+#include <nlohmann/json.hpp>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int MANIFEST_VERSION = 1;
+
+} // end anonymous namespace
+
+bool BatchManifest::load(const fs::path& manifestPath) {
+    std::ifstream manifestFile(manifestPath);
+    if (!manifestFile.is_open()) {
+        return false;
+    }
+
+    try {
+        json j;
+        manifestFile >> j;
+        if (j.value("version", 0) != MANIFEST_VERSION) {
+            LOG_WARN << "Warning: Ignoring manifest with unsupported version: " << manifestPath.string();
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_configFingerprint = j.value("configFingerprint", std::string());
+        m_entries.clear();
+        const json files = j.value("files", json::object());
+        for (const auto& item : files.items()) {
+            const json& value = item.value();
+            ManifestEntry entry;
+            entry.size = value.value("size", uint64_t{0});
+            entry.mtime = value.value("mtime", int64_t{0});
+            entry.hash = std::stoull(value.value("hash", std::string("0")), nullptr, 16);
+            entry.outputs = value.value("outputs", std::vector<std::string>());
+            m_entries[item.key()] = std::move(entry);
+        }
+    } catch (const std::exception& e) {
+        LOG_WARN << "Warning: Failed to parse manifest '" << manifestPath.string() << "': " << e.what();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+        m_configFingerprint.clear();
+        return false;
+    }
+    return true;
+}
+
+bool BatchManifest::save(const fs::path& manifestPath) const {
+    json j;
+    j["version"] = MANIFEST_VERSION;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        j["configFingerprint"] = m_configFingerprint;
+        json files = json::object();
+        for (const auto& kv : m_entries) {
+            files[kv.first] = {
+                {"size", kv.second.size},
+                {"mtime", kv.second.mtime},
+                {"hash", ContentHash::toHex(kv.second.hash)},
+                {"outputs", kv.second.outputs}
+            };
+        }
+        j["files"] = std::move(files);
+    }
+
+    fs::path tmpPath = manifestPath;
+    tmpPath += ".tmp";
+    {
+        std::ofstream manifestFile(tmpPath);
+        if (!manifestFile.is_open()) {
+            LOG_ERROR << "Error: Could not open manifest for writing: " << tmpPath.string();
+            return false;
+        }
+        manifestFile << j.dump(1) << std::endl;
+        if (!manifestFile) {
+            LOG_ERROR << "Error: Failed to write manifest: " << tmpPath.string();
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmpPath, manifestPath, ec);
+    if (ec) {
+        LOG_ERROR << "Error: Failed to replace manifest '" << manifestPath.string() << "': " << ec.message();
+        return false;
+    }
+    return true;
+}
+
+std::optional<ManifestEntry> BatchManifest::find(const std::string& inputKey) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(inputKey);
+    if (it == m_entries.end()) return std::nullopt;
+    return it->second;
+}
+
+void BatchManifest::set(const std::string& inputKey, ManifestEntry entry) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries[inputKey] = std::move(entry);
+}
+
+void BatchManifest::erase(const std::string& inputKey) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.erase(inputKey);
+}
+
+size_t BatchManifest::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+void BatchManifest::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_configFingerprint.clear();
+}
+
+void BatchManifest::mergeFrom(const BatchManifest& other) {
+    std::map<std::string, ManifestEntry> otherEntries;
+    {
+        std::lock_guard<std::mutex> lock(other.m_mutex);
+        otherEntries = other.m_entries;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& kv : otherEntries) {
+        m_entries[kv.first] = std::move(kv.second);
+    }
+}
+
+std::string computeConfigFingerprint(const Config& config) {
+    std::ostringstream canonical;
+    canonical << "targetWidth=" << config.targetWidth << "\n";
+    canonical << "charAspectRatioCorrection=" << config.charAspectRatioCorrection << "\n";
+    canonical << "fontFilename=" << config.fontFilename << "\n";
+    canonical << "fontSize=" << config.fontSize << "\n";
+    canonical << "imageOutputSubDirSuffix=" << config.imageOutputSubDirSuffix << "\n";
+    canonical << "generateHtmlOutput=" << config.generateHtmlOutput << "\n";
+    canonical << "htmlFontSizePt=" << config.htmlFontSizePt << "\n";
+    canonical << "generateSvgOutput=" << config.generateSvgOutput << "\n";
+    canonical << "writeAsciiGrid=" << config.writeAsciiGrid << "\n";
+    canonical << "asciiChars=" << ASCII_CHARS << "\n";
+    canonical << "colorSchemes=";
+    for (const auto& scheme : config.schemesToGenerate) {
+        canonical << colorSchemeToString(scheme) << ",";
+    }
+    std::string text = canonical.str();
+    return ContentHash::toHex(ContentHash::hashBytes(text.data(), text.size()));
+}
+
+int64_t getFileMtimeTicks(const fs::path& filePath) {
+    std::error_code ec;
+    auto mtime = fs::last_write_time(filePath, ec);
+    if (ec) return 0;
+    return static_cast<int64_t>(mtime.time_since_epoch().count());
+}
@@ -0,0 +1,54 @@
+#ifndef BATCH_MANIFEST_H
+#define BATCH_MANIFEST_H
+
+#include "common/common_types.h"
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+// 批处理清单：记录每个输入文件的大小、修改时间、内容哈希及其生成的输出文件，
+// 以及生成这些输出时的配置指纹。再次运行时据此跳过未变化的输入。
+struct ManifestEntry {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t hash = 0;
+    std::vector<std::string> outputs; // 相对于批处理输出目录
+};
+
+class BatchManifest {
+public:
+    static constexpr const char* FILENAME = "_manifest.json";
+
+    // 读取已有清单。文件不存在或无法解析时返回 false（清单保持为空）。
+    bool load(const std::filesystem::path& manifestPath);
+    // 先写临时文件再重命名，中途中断不会留下损坏的清单
+    bool save(const std::filesystem::path& manifestPath) const;
+
+    const std::string& getConfigFingerprint() const { return m_configFingerprint; }
+    void setConfigFingerprint(const std::string& fingerprint) { m_configFingerprint = fingerprint; }
+
+    std::optional<ManifestEntry> find(const std::string& inputKey) const;
+    void set(const std::string& inputKey, ManifestEntry entry);
+    void erase(const std::string& inputKey);
+    size_t size() const;
+    void clear();
+    // 合并另一份清单的条目（同名键以 other 为准），用于合并分片清单
+    void mergeFrom(const BatchManifest& other);
+
+private:
+    std::string m_configFingerprint;
+    std::map<std::string, ManifestEntry> m_entries; // 有序，保证输出稳定
+    mutable std::mutex m_mutex;
+};
+
+// 只包含影响输出内容的配置项；日志/缓存等设置变化不会使清单失效。
+std::string computeConfigFingerprint(const Config& config);
+
+// 文件的修改时间，以文件时钟的原始计数表示（仅用于同一平台上的相等比较）
+int64_t getFileMtimeTicks(const std::filesystem::path& filePath);
+
+#endif // BATCH_MANIFEST_H
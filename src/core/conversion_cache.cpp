@@ -0,0 +1,181 @@
+#include "conversion_cache.h"
+#include "conversion/ascii_grid_file.h"
+#include "utils/ContentHash.h"
+#include "utils/Logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 淘汰时降到上限的 90%，避免每次写入都触发一次全量淘汰
+constexpr double EVICTION_TARGET_RATIO = 0.9;
+
+bool parseKeyFromFilename(const fs::path& p, uint64_t& key) {
+    if (!isAsciiGridFile(p)) return false;
+    std::string stem = p.stem().string();
+    if (stem.size() != 16) return false;
+    try {
+        key = std::stoull(stem, nullptr, 16);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+} // end anonymous namespace
+
+ConversionCache::ConversionCache(const fs::path& cacheDir, uint64_t maxBytes)
+    : m_cacheDir(cacheDir), m_maxBytes(maxBytes) {
+    std::error_code ec;
+    fs::create_directories(m_cacheDir, ec);
+    if (ec || !fs::is_directory(m_cacheDir)) {
+        LOG_WARN << "Warning: Cannot use conversion cache directory '" << m_cacheDir.string()
+                 << "'. Cache disabled.";
+        return;
+    }
+    m_enabled = true;
+    scanExistingEntries();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        evictIfNeeded(); // 上限可能在两次运行之间被调小
+    }
+    LOG_INFO << "Info: Conversion cache at '" << m_cacheDir.string() << "' (" << m_entries.size()
+             << " entries, " << (m_totalBytes / (1024 * 1024)) << " MB of " << (m_maxBytes / (1024 * 1024)) << " MB).";
+}
+
+uint64_t ConversionCache::makeKey(uint64_t sourceHash, int targetWidth, double aspectRatioCorrection) {
+    ContentHash::Hasher hasher(sourceHash);
+    int64_t width = targetWidth;
+    uint64_t aspectBits = 0;
+    static_assert(sizeof(aspectBits) == sizeof(aspectRatioCorrection), "double must be 64-bit");
+    std::memcpy(&aspectBits, &aspectRatioCorrection, sizeof(aspectBits));
+    uint16_t version = ASCII_GRID_FORMAT_VERSION;
+    hasher.update(&width, sizeof(width));
+    hasher.update(&aspectBits, sizeof(aspectBits));
+    hasher.update(&version, sizeof(version));
+    hasher.update(ASCII_CHARS.data(), ASCII_CHARS.size());
+    return hasher.digest();
+}
+
+fs::path ConversionCache::entryPath(uint64_t key) const {
+    std::string hex = ContentHash::toHex(key);
+    return m_cacheDir / hex.substr(0, 2) / (hex + ASCII_GRID_EXTENSION);
+}
+
+void ConversionCache::scanExistingEntries() {
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(m_cacheDir, ec), end; !ec && it != end; it.increment(ec)) {
+        // 其他进程可能同时在淘汰条目：文件在枚举后消失时跳过它，而不是抛出异常中止运行
+        std::error_code entryEc;
+        uint64_t key = 0;
+        if (!it->is_regular_file(entryEc) || entryEc || !parseKeyFromFilename(it->path(), key)) continue;
+        Entry entry;
+        entry.sizeBytes = it->file_size(entryEc);
+        if (entryEc) continue;
+        entry.lastUsed = it->last_write_time(entryEc);
+        if (entryEc) continue;
+        m_totalBytes += entry.sizeBytes;
+        m_entries[key] = entry;
+    }
+}
+
+std::optional<AsciiConversionResult> ConversionCache::lookup(uint64_t key) {
+    if (!m_enabled) return std::nullopt;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_entries.find(key) == m_entries.end()) {
+            m_misses++;
+            return std::nullopt;
+        }
+    }
+
+    fs::path path = entryPath(key);
+    auto result = loadAsciiGridFile(path);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(key);
+    if (!result) {
+        // 条目被外部删除或已损坏：从索引移除，按未命中处理
+        if (it != m_entries.end()) {
+            m_totalBytes -= it->second.sizeBytes;
+            m_entries.erase(it);
+        }
+        std::error_code ec;
+        fs::remove(path, ec);
+        m_misses++;
+        return std::nullopt;
+    }
+
+    // 刷新修改时间，使 LRU 顺序在多次运行之间保持
+    auto now = fs::file_time_type::clock::now();
+    std::error_code ec;
+    fs::last_write_time(path, now, ec);
+    if (it != m_entries.end()) it->second.lastUsed = now;
+    m_hits++;
+    return result;
+}
+
+void ConversionCache::store(uint64_t key, const AsciiConversionResult& result) {
+    if (!m_enabled) return;
+
+    fs::path path = entryPath(key);
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+
+    // 先写临时文件再重命名，避免并发的读者看到写了一半的条目
+    std::ostringstream tmpName;
+    tmpName << path.filename().string() << ".tmp" << std::this_thread::get_id();
+    fs::path tmpPath = path.parent_path() / tmpName.str();
+    if (!writeAsciiGridFile(result, tmpPath)) {
+        fs::remove(tmpPath, ec);
+        return;
+    }
+    fs::rename(tmpPath, path, ec);
+    if (ec) {
+        LOG_WARN << "Warning: Failed to store conversion cache entry '" << path.string() << "': " << ec.message();
+        fs::remove(tmpPath, ec);
+        return;
+    }
+
+    uint64_t size = fs::file_size(path, ec);
+    if (ec) return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry& entry = m_entries[key];
+    m_totalBytes -= entry.sizeBytes; // 覆盖已有条目时先扣除旧大小
+    entry.sizeBytes = size;
+    entry.lastUsed = fs::file_time_type::clock::now();
+    m_totalBytes += size;
+    evictIfNeeded();
+}
+
+void ConversionCache::evictIfNeeded() {
+    if (m_totalBytes <= m_maxBytes) return;
+
+    std::vector<std::pair<fs::file_time_type, uint64_t>> byAge;
+    byAge.reserve(m_entries.size());
+    for (const auto& kv : m_entries) {
+        byAge.emplace_back(kv.second.lastUsed, kv.first);
+    }
+    std::sort(byAge.begin(), byAge.end());
+
+    const uint64_t target = static_cast<uint64_t>(m_maxBytes * EVICTION_TARGET_RATIO);
+    size_t evicted = 0;
+    for (const auto& ageKey : byAge) {
+        if (m_totalBytes <= target) break;
+        std::error_code ec;
+        fs::remove(entryPath(ageKey.second), ec);
+        m_totalBytes -= m_entries[ageKey.second].sizeBytes;
+        m_entries.erase(ageKey.second);
+        ++evicted;
+    }
+    LOG_INFO << "Info: Conversion cache evicted " << evicted << " least recently used entr"
+             << (evicted == 1 ? "y" : "ies") << ".";
+}
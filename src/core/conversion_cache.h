@@ -0,0 +1,53 @@
+#ifndef CONVERSION_CACHE_H
+#define CONVERSION_CACHE_H
+
+#include "conversion/image_converter.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+// 基于内容寻址的磁盘转换缓存。
+// 键 = 源文件字节哈希 + 转换参数（targetWidth、charAspectRatioCorrection、字符表、格式版本）。
+// 条目以 .agrid 文件存放在 <cacheDir>/<键的前两位十六进制>/<键>.agrid 下；
+// 总大小超过上限时按最近使用时间（文件修改时间，命中时刷新）淘汰最旧的条目。
+class ConversionCache {
+public:
+    ConversionCache(const std::filesystem::path& cacheDir, uint64_t maxBytes);
+
+    // 目录无法创建时缓存被禁用，lookup/store 变为空操作
+    bool isEnabled() const { return m_enabled; }
+
+    static uint64_t makeKey(uint64_t sourceHash, int targetWidth, double aspectRatioCorrection);
+
+    std::optional<AsciiConversionResult> lookup(uint64_t key);
+    void store(uint64_t key, const AsciiConversionResult& result);
+
+    int getHitCount() const { return m_hits.load(); }
+    int getMissCount() const { return m_misses.load(); }
+
+private:
+    struct Entry {
+        uint64_t sizeBytes = 0;
+        std::filesystem::file_time_type lastUsed;
+    };
+
+    std::filesystem::path entryPath(uint64_t key) const;
+    void scanExistingEntries();
+    void evictIfNeeded(); // 调用方须持有 m_mutex
+
+    std::filesystem::path m_cacheDir;
+    uint64_t m_maxBytes;
+    bool m_enabled = false;
+
+    std::mutex m_mutex;
+    std::unordered_map<uint64_t, Entry> m_entries;
+    uint64_t m_totalBytes = 0;
+
+    std::atomic<int> m_hits{0};
+    std::atomic<int> m_misses{0};
+};
+
+#endif // CONVERSION_CACHE_H
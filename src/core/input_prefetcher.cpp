@@ -0,0 +1,68 @@
+#include "input_prefetcher.h"
+#include <algorithm>
+#include <vector>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// 请求内核在后台把整个文件读入页缓存；关闭描述符后已发起的预读仍会继续
+void adviseWillNeed(const std::filesystem::path& path) {
+#if defined(POSIX_FADV_WILLNEED)
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return; // 打不开的文件留给解码阶段报告错误
+    }
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    ::close(fd);
+#else
+    (void)path;
+#endif
+}
+
+} // end anonymous namespace
+
+InputPrefetcher::InputPrefetcher(uint64_t budgetBytes) : m_budgetBytes(budgetBytes) {}
+
+void InputPrefetcher::enqueue(size_t id, const std::filesystem::path& path, uint64_t size) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_pending.push_back(Pending{id, path, size});
+    pump(lock);
+}
+
+void InputPrefetcher::release(size_t id) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto it = m_inFlight.find(id);
+    if (it != m_inFlight.end()) {
+        m_inFlightBytes -= it->second;
+        m_inFlight.erase(it);
+    } else {
+        m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(), [id](const Pending& p) { return p.id == id; }),
+                        m_pending.end());
+    }
+    pump(lock);
+}
+
+void InputPrefetcher::pump(std::unique_lock<std::mutex>& lock) {
+    std::vector<std::filesystem::path> toAdvise;
+    // 没有任何预读在进行时，超出预算的单个大文件也放行，否则它之后的输入永远得不到预读
+    while (!m_pending.empty()
+           && (m_inFlight.empty() || m_inFlightBytes + m_pending.front().size <= m_budgetBytes)) {
+        Pending next = std::move(m_pending.front());
+        m_pending.pop_front();
+        m_inFlight.emplace(next.id, next.size);
+        m_inFlightBytes += next.size;
+        toAdvise.push_back(std::move(next.path));
+    }
+    if (toAdvise.empty()) {
+        return;
+    }
+    lock.unlock();
+    for (const auto& path : toAdvise) {
+        adviseWillNeed(path);
+    }
+    lock.lock();
+}
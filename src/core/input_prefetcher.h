@@ -0,0 +1,43 @@
+#ifndef INPUT_PREFETCHER_H
+#define INPUT_PREFETCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+
+// 批处理输入预读：排队等待处理的文件按提交顺序通过 posix_fadvise(WILLNEED) 让内核提前读入页缓存，
+// 工作线程开始解码时数据已在内存中。已预读但尚未开始处理的字节数不超过预算，
+// 任务开始时归还预算并继续为后面的输入预读。不支持 fadvise 的平台上不做任何事。
+class InputPrefetcher {
+public:
+    explicit InputPrefetcher(uint64_t budgetBytes);
+
+    InputPrefetcher(const InputPrefetcher&) = delete;
+    InputPrefetcher& operator=(const InputPrefetcher&) = delete;
+
+    // 登记一个已排队的输入，id 在本次批处理中唯一
+    void enqueue(size_t id, const std::filesystem::path& path, uint64_t size);
+    // 输入开始处理：归还它占用的预算（尚未预读时直接移出队列）
+    void release(size_t id);
+
+private:
+    struct Pending {
+        size_t id;
+        std::filesystem::path path;
+        uint64_t size;
+    };
+
+    // 在预算内为队首的输入发出预读；fadvise 可能阻塞（例如 NFS），在锁外执行
+    void pump(std::unique_lock<std::mutex>& lock);
+
+    const uint64_t m_budgetBytes;
+    std::mutex m_mutex;
+    std::deque<Pending> m_pending;
+    std::unordered_map<size_t, uint64_t> m_inFlight; // 已预读、尚未开始处理的输入
+    uint64_t m_inFlightBytes = 0;
+};
+
+#endif // INPUT_PREFETCHER_H
@@ -1,20 +1,90 @@
 #include "processing_orchestrator.h"
 #include "conversion/image_converter.h"
+#include "conversion/ascii_grid_file.h"
 #include "rendering/PngRenderer.h"
 #include "rendering/HtmlRenderer.h"
+#include "rendering/SvgRenderer.h"
 #include "config/config_handler.h"
 #include "utils/PathManager.h"
+#include "utils/ContentHash.h"
+#include "utils/GlobMatcher.h"
+#include "utils/TarReader.h"
+#include "utils/MappedFile.h"
+#include "utils/BufferPool.h"
+#include "batch_manifest.h"
+#include "input_prefetcher.h"
+#include "progress_reporter.h"
+#include "run_report.h"
+#include "utils/Logger.h"
+#include "utils/Trace.h"
 
-#include <iostream>
-#include <future>
 #include <chrono>
 #include <iomanip>
-#include <functional> // For std::cref
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <set>
+#include <unordered_map>
 
 using namespace std::chrono;
 
+namespace {
+
+// 增量模式：输入的大小与修改时间都未变化，或修改时间变化但内容哈希相同，
+// 且上次生成的所有输出仍然存在时，视为无需重新处理。哈希只在需要时通过 computeHash 计算。
+bool isUnchangedSinceLastRun(const std::function<uint64_t()>& computeHash, uint64_t size, int64_t mtime,
+                             const ManifestEntry& previous, const std::filesystem::path& batchOutputDir) {
+    if (previous.size != size || previous.outputs.empty()) {
+        return false;
+    }
+    for (const auto& output : previous.outputs) {
+        std::error_code ec;
+        if (!std::filesystem::exists(batchOutputDir / output, ec)) {
+            return false;
+        }
+    }
+    if (previous.mtime == mtime) {
+        return true;
+    }
+    const uint64_t hash = computeHash();
+    return hash != 0 && hash == previous.hash;
+}
+
+// 重复输入的输出与主副本共享硬链接；重写前先断开链接，避免同时改写其他副本的输出
+void detachSharedOutput(const std::filesystem::path& outputPath) {
+    std::error_code ec;
+    if (std::filesystem::hard_link_count(outputPath, ec) > 1) {
+        std::filesystem::remove(outputPath, ec);
+    }
+}
+
+// 每张图片的输出子目录名，例如 cat_512_ascii_output
+std::string imageOutputDirName(const std::filesystem::path& imagePath, const Config& config) {
+    return imagePath.stem().string() + "_" + std::to_string(config.targetWidth) + config.imageOutputSubDirSuffix;
+}
+
+} // end anonymous namespace
+
 ProcessingOrchestrator::ProcessingOrchestrator(const Config& config) : m_config(config) {
     setupRenderers();
+    if (!m_config.conversionCacheDir.empty()) {
+        uint64_t maxBytes = static_cast<uint64_t>(std::max(0, m_config.conversionCacheMaxMB)) * 1024 * 1024;
+        m_cache = std::make_unique<ConversionCache>(m_config.conversionCacheDir, maxBytes);
+    }
+}
+
+ProcessingStats ProcessingOrchestrator::getStats() const {
+    ProcessingStats stats;
+    stats.processedCount = m_processedCount;
+    stats.failedCount = m_failedCount;
+    stats.unchangedCount = m_unchangedCount;
+    stats.duplicateCount = m_duplicateCount;
+    if (m_cache && m_cache->isEnabled()) {
+        stats.cacheEnabled = true;
+        stats.cacheHits = m_cache->getHitCount();
+        stats.cacheMisses = m_cache->getMissCount();
+    }
+    return stats;
 }
 
 void ProcessingOrchestrator::setupRenderers() {
@@ -22,162 +92,909 @@ void ProcessingOrchestrator::setupRenderers() {
     if (m_config.generateHtmlOutput) {
         m_renderers.push_back(std::make_unique<HtmlRenderer>());
     }
+    if (m_config.generateSvgOutput) {
+        m_renderers.push_back(std::make_unique<SvgRenderer>());
+    }
 }
 
 void ProcessingOrchestrator::process(const std::filesystem::path& inputPath) {
     if (!std::filesystem::exists(inputPath)) {
-        std::cerr << "Error: Input path does not exist: " << inputPath.string() << std::endl;
+        LOG_ERROR << "Error: Input path does not exist: " << inputPath.string();
         m_failedCount++;
         return;
     }
 
-    if (std::filesystem::is_regular_file(inputPath)) {
+    if (std::filesystem::is_regular_file(inputPath) && isTarArchive(inputPath)) {
+        processArchive(inputPath);
+    } else if (std::filesystem::is_regular_file(inputPath)) {
         processSingleImage(inputPath);
     } else if (std::filesystem::is_directory(inputPath)) {
         processDirectory(inputPath);
     } else {
-        std::cerr << "Error: Input path is not a file or directory: " << inputPath.string() << std::endl;
+        LOG_ERROR << "Error: Input path is not a file or directory: " << inputPath.string();
         m_failedCount++;
     }
 }
 
 void ProcessingOrchestrator::processSingleImage(const std::filesystem::path& imagePath) {
-    std::cout << "\nInput is a single file." << std::endl;
-    if (isImageFile(imagePath)) {
-        std::string imageSubDirName = imagePath.stem().string() + "_" + std::to_string(m_config.targetWidth) + m_config.imageOutputSubDirSuffix;
-        m_finalMainOutputDirPath = PathManager::setupOutputDirectory(imagePath.parent_path(), imageSubDirName);
+    LOG_INFO << "\nInput is a single file.";
+    if (isImageFile(imagePath) || isAsciiGridFile(imagePath)) {
+        m_finalMainOutputDirPath = PathManager::setupOutputDirectory(imagePath.parent_path(), imageOutputDirName(imagePath, m_config));
 
         if (!m_finalMainOutputDirPath.empty()) {
             std::filesystem::path configOutputPath = m_finalMainOutputDirPath / "_run_config.txt";
             if (!writeConfigToFile(m_config, configOutputPath)) {
-                std::cerr << "Warning: Failed to write configuration file for this run." << std::endl;
+                LOG_WARN << "Warning: Failed to write configuration file for this run.";
             }
-            if (processImageFile(imagePath, m_finalMainOutputDirPath)) {
+            ImageTaskResult result = processImageFile(imagePath, m_finalMainOutputDirPath);
+            if (m_fileWriter) {
+                m_fileWriter->drain();
+            }
+            const bool written = !*result.writeFailed;
+            if (result.success && written) {
                 m_processedCount++;
             } else {
                 m_failedCount++;
             }
+            result.report.input = imagePath.filename().string();
+            result.report.status = result.success ? "processed" : "failed";
+            const long reportIndex = addImageReport(std::move(result.report));
+            if (result.success && !written) {
+                markReportFailed(reportIndex, "Not all outputs could be written.");
+            }
         } else {
-            std::cerr << "Error: Failed to create output directory for " << imagePath.filename().string() << ". Skipping." << std::endl;
+            LOG_ERROR << "Error: Failed to create output directory for " << imagePath.filename().string() << ". Skipping.";
             m_failedCount++;
         }
     } else {
-        std::cerr << "Error: Input file is not a supported image type: " << imagePath.string() << std::endl;
+        LOG_ERROR << "Error: Input file is not a supported image type: " << imagePath.string();
         m_failedCount++;
     }
 }
 
+// 一个批处理输入。枚举线程只写入发现信息和去重哈希；outputs 由处理它的工作线程写入，
+// 在线程池空闲后才被读取（链接重复项时）。
+struct ProcessingOrchestrator::BatchInput {
+    std::filesystem::path sourcePath;
+    std::filesystem::path relativePath; // 相对于输入根目录，用作清单键和镜像输出目录
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    bool hashed = false;  // 仅在出现大小相同的输入时才计算哈希
+    uint64_t hash = 0;    // 0 表示无法读取
+    long duplicateOf = -1;
+    bool inMemory = false;             // 来自 tar 归档：sourcePath 只是条目名，内容在 bytes 中
+    std::vector<unsigned char> bytes;  // 处理完成后释放
+    std::vector<std::filesystem::path> outputs;
+    std::shared_ptr<std::atomic<bool>> writeFailed; // 由工作线程写入，批次结束 drain 之后读取
+    long reportIndex = -1;                          // --report 中的记录
+};
+
+struct ProcessingOrchestrator::BatchRun {
+    std::filesystem::path outputRoot;
+    bool incremental = false;
+    std::filesystem::path manifestPath;
+    BatchManifest previousManifest;
+    BatchManifest currentManifest;
+    std::deque<BatchInput> inputs; // deque：追加元素时已有元素的引用保持有效
+    std::unordered_map<uint64_t, std::vector<size_t>> primariesBySize;
+    std::vector<size_t> duplicates;
+    std::unique_ptr<InputPrefetcher> prefetcher; // nullptr when prefetchBudgetMB is 0
+    steady_clock::time_point startTime;
+};
+
+ThreadPool& ProcessingOrchestrator::getWorkerPool() {
+    if (!m_pool) {
+        size_t threadCount = m_config.workerThreads > 0 ? static_cast<size_t>(m_config.workerThreads) : ThreadPool::defaultThreadCount();
+        // 队列有上限：枚举速度远快于处理时会在这里等待，而不是一次性把整棵目录树读入内存
+        m_pool = std::make_unique<ThreadPool>(threadCount, threadCount * 4);
+    }
+    return *m_pool;
+}
+
 void ProcessingOrchestrator::processDirectory(const std::filesystem::path& dirPath) {
-    std::cout << "\nInput is a directory. Processing images concurrently..." << std::endl;
+    LOG_INFO << "\nInput is a directory. Scanning " << (m_config.recursiveScan ? "recursively " : "")
+             << "and processing images as they are found...";
     std::string batchDirName = dirPath.filename().string() + "_" + std::to_string(m_config.targetWidth) + m_config.batchOutputSubDirSuffix;
     m_finalMainOutputDirPath = PathManager::setupOutputDirectory(dirPath.parent_path(), batchDirName);
 
     if (m_finalMainOutputDirPath.empty()) {
-        std::cerr << "Error: Failed to create main batch output directory. Aborting." << std::endl;
+        LOG_ERROR << "Error: Failed to create main batch output directory. Aborting.";
+        return;
+    }
+
+    // 各分片共享同一输出目录，运行配置只由第一个分片写入
+    std::filesystem::path configOutputPath = m_finalMainOutputDirPath / "_run_config.txt";
+    if (m_shard.index == 0 && !writeConfigToFile(m_config, configOutputPath)) {
+        LOG_WARN << "Warning: Failed to write configuration file for this batch run.";
+    }
+
+    BatchRun run;
+    run.outputRoot = m_finalMainOutputDirPath;
+    beginBatch(run);
+    enumerateDirectory(run, dirPath);
+
+    if (run.inputs.empty()) {
+        LOG_INFO << "No supported image files found in directory: " << dirPath.string();
+    } else {
+        LOG_INFO << "Found " << run.inputs.size() << " image(s). Waiting for processing tasks to complete...";
+    }
+    finishBatch(run);
+}
+
+void ProcessingOrchestrator::processFileList(std::istream& listStream, bool nulSeparated, const std::string& listName) {
+    LOG_INFO << "\nReading image paths from " << listName << (nulSeparated ? " (NUL-separated)" : "")
+             << " and processing them as they arrive...";
+    std::string batchDirName = listName + "_" + std::to_string(m_config.targetWidth) + m_config.batchOutputSubDirSuffix;
+    m_finalMainOutputDirPath = PathManager::setupOutputDirectory(std::filesystem::current_path(), batchDirName);
+
+    if (m_finalMainOutputDirPath.empty()) {
+        LOG_ERROR << "Error: Failed to create main batch output directory. Aborting.";
         return;
     }
 
+    // 各分片共享同一输出目录，运行配置只由第一个分片写入
     std::filesystem::path configOutputPath = m_finalMainOutputDirPath / "_run_config.txt";
-    if (!writeConfigToFile(m_config, configOutputPath)) {
-        std::cerr << "Warning: Failed to write configuration file for this batch run." << std::endl;
+    if (m_shard.index == 0 && !writeConfigToFile(m_config, configOutputPath)) {
+        LOG_WARN << "Warning: Failed to write configuration file for this batch run.";
     }
 
-    std::vector<std::filesystem::path> imageFilesToProcess;
-    for (const auto& entry : std::filesystem::directory_iterator(dirPath)) {
-        if (entry.is_regular_file() && isImageFile(entry.path())) {
-            imageFilesToProcess.push_back(entry.path());
+    BatchRun run;
+    run.outputRoot = m_finalMainOutputDirPath;
+    beginBatch(run);
+
+    const char separator = nulSeparated ? '\0' : '\n';
+    std::string line;
+    while (std::getline(listStream, line, separator)) {
+        if (!nulSeparated && !line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) continue;
+
+        std::filesystem::path inputPath(line);
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file(inputPath, ec)) {
+            LOG_ERROR << "Error: Listed path is not a readable file: " << line;
+            m_failedCount++;
+            continue;
+        }
+        if (!isImageFile(inputPath) && !isAsciiGridFile(inputPath)) {
+            LOG_ERROR << "Error: Listed file is not a supported image type: " << line;
+            m_failedCount++;
+            continue;
+        }
+
+        // 相对路径（不跳出当前目录时）原样镜像；其余使用去掉根的绝对路径，保证不同目录的同名文件不冲突
+        std::filesystem::path relativePath = inputPath.lexically_normal();
+        if (relativePath.is_absolute() || relativePath.empty() || *relativePath.begin() == "..") {
+            relativePath = std::filesystem::absolute(inputPath, ec).lexically_normal().relative_path();
         }
+        submitBatchInput(run, inputPath, relativePath);
     }
 
-    if (imageFilesToProcess.empty()) {
-        std::cout << "No supported image files found in directory: " << dirPath.string() << std::endl;
+    if (run.inputs.empty()) {
+        LOG_INFO << "No supported image files were listed.";
     } else {
-        std::cout << "Found " << imageFilesToProcess.size() << " image(s) to process." << std::endl;
-        std::vector<std::future<bool>> futures;
-        futures.reserve(imageFilesToProcess.size());
-
-        for(const auto& imgPath : imageFilesToProcess) {
-            std::string imageSubDirName = imgPath.stem().string() + "_" + std::to_string(m_config.targetWidth) + m_config.imageOutputSubDirSuffix;
-            std::filesystem::path imageSpecificOutputDir = PathManager::setupOutputDirectory(m_finalMainOutputDirPath, imageSubDirName);
-
-            if (!imageSpecificOutputDir.empty()) {
-                futures.push_back(
-                    std::async(std::launch::async,
-                               &ProcessingOrchestrator::processImageFile, this,
-                               imgPath,
-                               imageSpecificOutputDir)
-                );
-            } else {
-                std::cerr << "Error: Failed to create output subdirectory for " << imgPath.filename().string() << " within batch. Skipping." << std::endl;
-                m_failedCount++;
+        LOG_INFO << "Read " << run.inputs.size() << " image path(s). Waiting for processing tasks to complete...";
+    }
+    finishBatch(run);
+}
+
+void ProcessingOrchestrator::processArchive(const std::filesystem::path& archivePath) {
+    LOG_INFO << "\nInput is a tar archive. Reading entries sequentially and processing images from memory...";
+    TarReader reader;
+    if (!reader.open(archivePath)) {
+        m_failedCount++;
+        return;
+    }
+
+    std::string batchDirName = archivePath.stem().string() + "_" + std::to_string(m_config.targetWidth) + m_config.batchOutputSubDirSuffix;
+    m_finalMainOutputDirPath = PathManager::setupOutputDirectory(archivePath.parent_path(), batchDirName);
+    if (m_finalMainOutputDirPath.empty()) {
+        LOG_ERROR << "Error: Failed to create main batch output directory. Aborting.";
+        return;
+    }
+
+    // 各分片共享同一输出目录，运行配置只由第一个分片写入
+    std::filesystem::path configOutputPath = m_finalMainOutputDirPath / "_run_config.txt";
+    if (m_shard.index == 0 && !writeConfigToFile(m_config, configOutputPath)) {
+        LOG_WARN << "Warning: Failed to write configuration file for this batch run.";
+    }
+
+    BatchRun run;
+    run.outputRoot = m_finalMainOutputDirPath;
+    beginBatch(run);
+
+    TarEntry entry;
+    while (reader.nextEntry(entry)) {
+        if (!entry.isRegularFile()) continue;
+        // .agrid 需要按路径映射读取，归档中只处理图片
+        std::filesystem::path relativePath = std::filesystem::path(entry.path).lexically_normal().relative_path();
+        if (relativePath.empty() || *relativePath.begin() == "..") {
+            LOG_WARN << "Warning: Skipping archive entry with an unsafe path: " << entry.path;
+            continue;
+        }
+        const std::string relativeKey = relativePath.generic_string();
+        if (!isImageFile(relativePath)) continue;
+        if (!m_config.includePatterns.empty() && !GlobMatcher::matchesAny(m_config.includePatterns, relativeKey)) continue;
+        if (GlobMatcher::matchesAny(m_config.excludePatterns, relativeKey)) continue;
+        if (!isInShard(relativePath)) continue; // 不属于本分片的条目直接跳过，不读取内容
+
+        std::vector<unsigned char> bytes;
+        {
+            TRACE_SPAN_DETAIL("read entry", relativeKey);
+            if (!reader.readData(bytes)) break;
+        }
+
+        BatchInput input;
+        input.sourcePath = relativePath;
+        input.relativePath = relativePath;
+        input.size = entry.size;
+        input.mtime = entry.mtime;
+        input.inMemory = true;
+        input.bytes = std::move(bytes);
+        admitBatchInput(run, std::move(input));
+    }
+    if (reader.hasError()) {
+        LOG_WARN << "Warning: Archive could not be read completely; processing the entries read so far.";
+        m_failedCount++;
+    }
+
+    if (run.inputs.empty()) {
+        LOG_INFO << "No supported image files found in archive: " << archivePath.string();
+    } else {
+        LOG_INFO << "Read " << run.inputs.size() << " image(s) from the archive. Waiting for processing tasks to complete...";
+    }
+    finishBatch(run);
+}
+
+void ProcessingOrchestrator::beginBatch(BatchRun& run) {
+    // --- 增量模式：读取上次运行的清单 ---
+    run.startTime = steady_clock::now();
+    run.incremental = m_config.incrementalBatch;
+    if (m_config.archiveBatchOutputs) {
+        const std::filesystem::path archivePath = run.outputRoot / ("_outputs" + m_shard.fileTag() + TAR_ARCHIVE_EXTENSION);
+        m_archiveWriter = std::make_unique<ArchiveOutputWriter>(archivePath, run.outputRoot);
+        if (!m_archiveWriter->isOpen()) {
+            LOG_WARN << "Warning: Cannot create output archive; writing individual files instead.";
+            m_archiveWriter.reset();
+        } else {
+            LOG_INFO << "Info: Writing outputs into " << archivePath.filename().string() << ".";
+            if (run.incremental) {
+                // 归档每次运行都会重写，清单中记录的输出无法复用
+                LOG_INFO << "Info: Incremental mode is not available when outputs are archived.";
+                run.incremental = false;
             }
         }
+    }
+    if (m_config.prefetchBudgetMB > 0) {
+        run.prefetcher = std::make_unique<InputPrefetcher>(static_cast<uint64_t>(m_config.prefetchBudgetMB) * 1024 * 1024);
+    }
+    run.manifestPath = run.outputRoot / ("_manifest" + m_shard.fileTag() + ".json");
+    if (m_shard.isSharded()) {
+        LOG_INFO << "Info: Running shard " << m_shard.index << "/" << m_shard.count << ".";
+    }
+    const std::string configFingerprint = computeConfigFingerprint(m_config);
+    run.currentManifest.setConfigFingerprint(configFingerprint);
+    if (run.incremental && run.previousManifest.load(run.manifestPath)) {
+        if (run.previousManifest.getConfigFingerprint() != configFingerprint) {
+            LOG_INFO << "Info: Output-affecting configuration changed since the last run. All inputs will be reprocessed.";
+            run.previousManifest.clear();
+        } else {
+            LOG_INFO << "Info: Loaded manifest with " << run.previousManifest.size() << " entries from the previous run.";
+        }
+    }
+}
+
+void ProcessingOrchestrator::enumerateDirectory(BatchRun& run, const std::filesystem::path& dirPath) {
+    namespace fs = std::filesystem;
+    fs::directory_options options = fs::directory_options::skip_permission_denied;
+    if (m_config.followSymlinks) {
+        options |= fs::directory_options::follow_directory_symlink;
+    }
 
-        std::cout << "Waiting for processing tasks to complete..." << std::endl;
-        for (size_t i = 0; i < futures.size(); ++i) {
-            try {
-                if (futures[i].valid()) {
-                    if (futures[i].get()) {
-                        m_processedCount++;
-                    } else {
-                        m_failedCount++;
-                    }
+    // 跟随符号链接时记录已进入目录的规范路径，防止链接成环导致无限递归
+    std::set<fs::path> visitedDirs;
+    std::error_code ec;
+    if (m_config.followSymlinks) {
+        visitedDirs.insert(fs::canonical(dirPath, ec));
+    }
+
+    fs::recursive_directory_iterator it(dirPath, options, ec);
+    if (ec) {
+        LOG_ERROR << "Error: Cannot read directory " << dirPath.string() << ": " << ec.message();
+        return;
+    }
+
+    for (const fs::recursive_directory_iterator end; it != end; it.increment(ec)) {
+        const fs::directory_entry& entry = *it;
+        const fs::path relativePath = entry.path().lexically_relative(dirPath);
+        const std::string relativeKey = relativePath.generic_string();
+
+        std::error_code statEc;
+        const bool isSymlink = entry.is_symlink(statEc);
+        if (entry.is_directory(statEc)) {
+            // "dir/**" 形式的排除模式也应剪掉目录本身，因此同时用带结尾 '/' 的路径匹配
+            bool descend = m_config.recursiveScan
+                           && !GlobMatcher::matchesAny(m_config.excludePatterns, relativeKey)
+                           && !GlobMatcher::matchesAny(m_config.excludePatterns, relativeKey + "/");
+            if (descend && isSymlink && !m_config.followSymlinks) {
+                descend = false;
+            }
+            if (descend && m_config.followSymlinks) {
+                descend = visitedDirs.insert(fs::canonical(entry.path(), statEc)).second;
+                if (!descend) {
+                    LOG_WARN << "Warning: Skipping already visited directory (symlink loop?): " << entry.path().string();
                 }
-            } catch (const std::exception& e) {
-                std::cerr << "Error retrieving result from processing task " << i << ": " << e.what() << std::endl;
+            }
+            if (!descend) {
+                it.disable_recursion_pending();
+            }
+            continue;
+        }
+
+        if (isSymlink && !m_config.followSymlinks) continue;
+        if (!entry.is_regular_file(statEc)) continue;
+        if (!isImageFile(entry.path()) && !isAsciiGridFile(entry.path())) continue;
+        if (!m_config.includePatterns.empty() && !GlobMatcher::matchesAny(m_config.includePatterns, relativeKey)) continue;
+        if (GlobMatcher::matchesAny(m_config.excludePatterns, relativeKey)) continue;
+
+        submitBatchInput(run, entry.path(), relativePath);
+    }
+    if (ec) {
+        LOG_WARN << "Warning: Directory scan stopped early: " << ec.message();
+    }
+}
+
+// 按相对路径分配，与机器、枚举顺序无关；各分片扫描同一棵目录树时结果一致
+bool ProcessingOrchestrator::isInShard(const std::filesystem::path& relativePath) const {
+    if (!m_shard.isSharded()) {
+        return true;
+    }
+    const std::string key = relativePath.generic_string();
+    return ContentHash::hashBytes(key.data(), key.size()) % static_cast<uint64_t>(m_shard.count) == static_cast<uint64_t>(m_shard.index);
+}
+
+void ProcessingOrchestrator::submitBatchInput(BatchRun& run, const std::filesystem::path& inputPath, const std::filesystem::path& relativePath) {
+    if (!isInShard(relativePath)) {
+        return;
+    }
+
+    BatchInput input;
+    input.sourcePath = inputPath;
+    input.relativePath = relativePath;
+    std::error_code ec;
+    input.size = std::filesystem::file_size(inputPath, ec);
+    input.mtime = getFileMtimeTicks(inputPath);
+    admitBatchInput(run, std::move(input));
+}
+
+// 输入内容的哈希，只计算一次；0 表示无法读取
+uint64_t ProcessingOrchestrator::getInputHash(BatchInput& input) {
+    if (!input.hashed) {
+        input.hash = input.inMemory ? ContentHash::hashBytes(input.bytes.data(), input.bytes.size())
+                                    : ContentHash::hashFile(input.sourcePath).value_or(0);
+        input.hashed = true;
+    }
+    return input.hash;
+}
+
+void ProcessingOrchestrator::admitBatchInput(BatchRun& run, BatchInput&& newInput) {
+    const size_t index = run.inputs.size();
+    run.inputs.push_back(std::move(newInput));
+    BatchInput& input = run.inputs.back();
+    if (input.inMemory && m_config.deduplicateInputs) {
+        // 内存中的内容在处理完成后即释放，之后到达的同大小条目无法再为它计算哈希，因此现在就算
+        getInputHash(input);
+    }
+
+    // --- 重复输入检测：相同内容只处理一次，输出在批次结束时链接 ---
+    if (m_config.deduplicateInputs) {
+        input.duplicateOf = findDuplicateInput(run, index);
+        if (input.duplicateOf >= 0) {
+            run.duplicates.push_back(index);
+            std::vector<unsigned char>().swap(input.bytes);
+            if (m_progress) m_progress->onSkipped();
+            return;
+        }
+    }
+
+    if (run.incremental) {
+        const std::string inputKey = input.relativePath.generic_string();
+        auto previousEntry = run.previousManifest.find(inputKey);
+        if (previousEntry && isUnchangedSinceLastRun([&] { return getInputHash(input); }, input.size, input.mtime, *previousEntry, run.outputRoot)) {
+            for (const auto& output : previousEntry->outputs) {
+                input.outputs.push_back(run.outputRoot / output);
+            }
+            previousEntry->mtime = input.mtime;
+            run.currentManifest.set(inputKey, std::move(*previousEntry));
+            m_unchangedCount++;
+            std::vector<unsigned char>().swap(input.bytes);
+            ImageReport report;
+            report.input = inputKey;
+            report.status = "unchanged";
+            addImageReport(std::move(report));
+            if (m_progress) m_progress->onSkipped();
+            return;
+        }
+    }
+
+    // 内存中的输入无需预读；文件输入在排队期间由内核读入页缓存
+    InputPrefetcher* prefetcher = input.inMemory ? nullptr : run.prefetcher.get();
+    if (prefetcher) {
+        prefetcher->enqueue(index, input.sourcePath, input.size);
+    }
+    BatchInput* task = &input;
+    if (m_progress) m_progress->onQueued();
+    getWorkerPool().submit([this, &run, task, prefetcher, index] {
+        if (prefetcher) {
+            prefetcher->release(index);
+        }
+        if (m_progress) m_progress->onStarted();
+        runBatchTask(run, *task);
+    });
+}
+
+// 流式去重：按大小分桶，只有出现大小相同的输入时才计算哈希（包括桶内尚未计算的主副本）。
+// 内容相同时，先被发现的输入为主副本。
+long ProcessingOrchestrator::findDuplicateInput(BatchRun& run, size_t index) {
+    BatchInput& input = run.inputs[index];
+    std::vector<size_t>& bucket = run.primariesBySize[input.size];
+    if (!bucket.empty()) {
+        if (getInputHash(input) != 0) {
+            for (size_t primaryIndex : bucket) {
+                if (getInputHash(run.inputs[primaryIndex]) == input.hash) {
+                    return static_cast<long>(primaryIndex);
+                }
+            }
+        }
+    }
+    bucket.push_back(index);
+    return -1;
+}
+
+void ProcessingOrchestrator::runBatchTask(BatchRun& run, BatchInput& input) {
+    // 在输出根目录下镜像输入的相对目录结构；归档模式下目录只体现在条目名中，不实际创建
+    std::filesystem::path outputDir = m_archiveWriter
+        ? run.outputRoot / input.relativePath.parent_path() / imageOutputDirName(input.sourcePath, m_config)
+        : PathManager::setupOutputDirectory(run.outputRoot / input.relativePath.parent_path(),
+                                            imageOutputDirName(input.sourcePath, m_config));
+    if (outputDir.empty()) {
+        LOG_ERROR << "Error: Failed to create output subdirectory for " << input.relativePath.string() << " within batch. Skipping.";
+        m_failedCount++;
+        ImageReport report;
+        report.input = input.relativePath.generic_string();
+        report.status = "failed";
+        report.error = "Failed to create output subdirectory.";
+        addImageReport(std::move(report));
+        if (m_progress) m_progress->onFinished(false, 0);
+        return;
+    }
+
+    ImageTaskResult result = processImageFile(input.sourcePath, outputDir, input.inMemory ? &input.bytes : nullptr);
+    if (m_progress) {
+        m_progress->onFinished(result.success, static_cast<uint64_t>(result.report.width) * static_cast<uint64_t>(result.report.height));
+    }
+    result.report.input = input.relativePath.generic_string();
+    result.report.status = result.success ? "processed" : "failed";
+    input.reportIndex = addImageReport(std::move(result.report));
+    // 枚举线程可能正在为文件输入计算 input.hash，这里不写入它；内存输入的哈希只在提交前计算
+    uint64_t sourceHash = result.sourceHash;
+    if (sourceHash == 0 && run.incremental && result.success) {
+        if (!input.inMemory) {
+            sourceHash = ContentHash::hashFile(input.sourcePath).value_or(0);
+        } else {
+            sourceHash = input.hashed ? input.hash : ContentHash::hashBytes(input.bytes.data(), input.bytes.size());
+        }
+    }
+    std::vector<unsigned char>().swap(input.bytes);
+    // 失败的输入不写入清单，下次运行会重试
+    if (!result.success) {
+        m_failedCount++;
+        return;
+    }
+    m_processedCount++;
+    input.outputs = result.outputs;
+    input.writeFailed = result.writeFailed;
+
+    if (run.incremental) {
+        ManifestEntry entry;
+        entry.size = input.size;
+        entry.mtime = input.mtime;
+        entry.hash = sourceHash;
+        for (const auto& output : result.outputs) {
+            entry.outputs.push_back(output.lexically_relative(run.outputRoot).generic_string());
+        }
+        run.currentManifest.set(input.relativePath.generic_string(), std::move(entry));
+    }
+}
+
+void ProcessingOrchestrator::finishBatch(BatchRun& run) {
+    if (m_progress) m_progress->setEnumerationComplete();
+    if (m_pool) {
+        TRACE_SPAN("wait workers");
+        m_pool->waitIdle();
+    }
+
+    // --- 等待异步写入完成；有输出没能写出的输入改记为失败，不写入清单，下次运行会重试 ---
+    if (m_fileWriter) {
+        {
+            TRACE_SPAN("drain writes");
+            m_fileWriter->drain();
+        }
+        for (auto& input : run.inputs) {
+            if (input.writeFailed && *input.writeFailed && !input.outputs.empty()) {
+                LOG_ERROR << "Error: Not all outputs for " << input.relativePath.string() << " could be written.";
+                markReportFailed(input.reportIndex, "Not all outputs could be written.");
+                input.outputs.clear();
+                run.currentManifest.erase(input.relativePath.generic_string());
+                m_processedCount--;
                 m_failedCount++;
             }
         }
     }
+
+    if (m_unchangedCount > 0) {
+        LOG_INFO << "Skipped " << m_unchangedCount << " unchanged image(s) recorded in the manifest.";
+    }
+    if (!run.duplicates.empty()) {
+        LOG_INFO << "Detected " << run.duplicates.size() << " duplicate input(s); linking their outputs.";
+    }
+
+    // --- 为重复输入物化输出：硬链接到主副本的输出（失败时复制） ---
+    for (size_t dupIndex : run.duplicates) {
+        const BatchInput& dup = run.inputs[dupIndex];
+        const BatchInput& primary = run.inputs[static_cast<size_t>(dup.duplicateOf)];
+        const std::string inputKey = dup.relativePath.generic_string();
+
+        if (run.incremental) {
+            auto previousEntry = run.previousManifest.find(inputKey);
+            if (previousEntry && isUnchangedSinceLastRun([&] { return dup.hash; }, dup.size, dup.mtime, *previousEntry, run.outputRoot)) {
+                previousEntry->mtime = dup.mtime;
+                run.currentManifest.set(inputKey, std::move(*previousEntry));
+                m_unchangedCount++;
+                ImageReport report;
+                report.input = inputKey;
+                report.status = "unchanged";
+                addImageReport(std::move(report));
+                continue;
+            }
+        }
+
+        ImageReport dupReport;
+        dupReport.input = inputKey;
+        dupReport.status = "failed";
+        if (primary.outputs.empty()) {
+            LOG_ERROR << "Error: Cannot link outputs for duplicate " << dup.relativePath.string() << " because "
+                      << primary.relativePath.string() << " failed. Skipping.";
+            m_failedCount++;
+            dupReport.error = "Duplicate of failed input " + primary.relativePath.generic_string() + ".";
+            addImageReport(std::move(dupReport));
+            continue;
+        }
+
+        std::filesystem::path imageSpecificOutputDir = m_archiveWriter
+            ? run.outputRoot / dup.relativePath.parent_path() / imageOutputDirName(dup.sourcePath, m_config)
+            : PathManager::setupOutputDirectory(run.outputRoot / dup.relativePath.parent_path(),
+                                                imageOutputDirName(dup.sourcePath, m_config));
+        if (imageSpecificOutputDir.empty()) {
+            LOG_ERROR << "Error: Failed to create output subdirectory for " << dup.relativePath.string() << " within batch. Skipping.";
+            m_failedCount++;
+            dupReport.error = "Failed to create output subdirectory.";
+            addImageReport(std::move(dupReport));
+            continue;
+        }
+
+        const std::string primaryStem = primary.sourcePath.stem().string();
+        const std::string dupStem = dup.sourcePath.stem().string();
+        std::vector<std::filesystem::path> linkedOutputs;
+        bool allLinked = true;
+        for (const auto& source : primary.outputs) {
+            // 输出文件名以输入文件名（不含扩展名）开头，替换为重复项自己的名字
+            std::string filename = source.filename().string();
+            if (filename.compare(0, primaryStem.size(), primaryStem) == 0) {
+                filename = dupStem + filename.substr(primaryStem.size());
+            }
+            std::filesystem::path target = imageSpecificOutputDir / filename;
+            const bool linked = m_archiveWriter ? m_archiveWriter->addLink(target, source)
+                                                : PathManager::linkOrCopyFile(source, target);
+            if (linked) {
+                linkedOutputs.push_back(target);
+            } else {
+                allLinked = false;
+            }
+        }
+        LOG_INFO << "Linked " << linkedOutputs.size() << " output(s) for duplicate " << dup.relativePath.string()
+                 << " (same content as " << primary.relativePath.string() << ")";
+
+        if (!allLinked) {
+            m_failedCount++;
+            dupReport.error = "Not all outputs could be linked.";
+            addImageReport(std::move(dupReport));
+            continue;
+        }
+        m_duplicateCount++;
+        dupReport.status = "duplicate";
+        addImageReport(std::move(dupReport));
+        if (run.incremental) {
+            ManifestEntry entry;
+            entry.size = dup.size;
+            entry.mtime = dup.mtime;
+            entry.hash = dup.hash;
+            for (const auto& output : linkedOutputs) {
+                entry.outputs.push_back(output.lexically_relative(run.outputRoot).generic_string());
+            }
+            run.currentManifest.set(inputKey, std::move(entry));
+        }
+    }
+
+    if (m_archiveWriter) {
+        if (!m_archiveWriter->finish()) {
+            LOG_ERROR << "Error: Failed to write output archive " << m_archiveWriter->getArchivePath().string() << ".";
+            m_failedCount++;
+        }
+        m_archiveWriter.reset();
+    }
+
+    if (run.incremental && !run.currentManifest.save(run.manifestPath)) {
+        LOG_WARN << "Warning: Failed to write batch manifest. The next run will reprocess all inputs.";
+    }
+
+    if (m_shard.isSharded()) {
+        ShardReport report;
+        report.shard = m_shard;
+        report.stats = getStats();
+        report.durationSeconds = duration_cast<duration<double>>(steady_clock::now() - run.startTime).count();
+        report.configFingerprint = run.currentManifest.getConfigFingerprint();
+        const std::filesystem::path reportPath = run.outputRoot / (std::string(RUN_REPORT_BASENAME) + m_shard.fileTag() + ".json");
+        if (writeShardReport(reportPath, report)) {
+            LOG_INFO << "Info: Wrote shard report " << reportPath.filename().string()
+                     << ". Run 'merge " << run.outputRoot.string() << "' after all shards finish.";
+        } else {
+            LOG_WARN << "Warning: Failed to write shard report.";
+        }
+    }
+}
+
+
+AsyncFileWriter& ProcessingOrchestrator::getFileWriter() {
+    // 批处理时由多个工作线程同时首次调用
+    std::call_once(m_fileWriterOnce, [this] {
+        m_fileWriter = std::make_unique<AsyncFileWriter>();
+        LOG_INFO << "Info: Writing outputs asynchronously (" << m_fileWriter->getBackendName() << ").";
+    });
+    return *m_fileWriter;
+}
+
+bool ProcessingOrchestrator::writeOutput(const std::filesystem::path& outputPath, const std::function<bool(OutputSink&)>& produce,
+                                         ImageTaskResult& result) {
+    uint64_t size = 0;
+    if (m_archiveWriter) {
+        ArchiveEntrySink sink(*m_archiveWriter, outputPath);
+        if (!produce(sink)) {
+            return false;
+        }
+        TRACE_SPAN_DETAIL("archive write", outputPath.filename().string());
+        if (!sink.finish()) {
+            return false;
+        }
+        size = sink.bytesWritten();
+    } else {
+        std::vector<unsigned char> bytes;
+        MemorySink sink(bytes);
+        if (!produce(sink)) {
+            return false;
+        }
+        size = bytes.size();
+        detachSharedOutput(outputPath);
+        getFileWriter().submit(outputPath, std::move(bytes), [writeFailed = result.writeFailed](bool success) {
+            if (!success) {
+                *writeFailed = true;
+            }
+        });
+    }
+    result.outputs.push_back(outputPath);
+    if (m_collectReports) {
+        result.report.outputs.emplace_back(outputPath.generic_string(), size);
+    }
+    return true;
 }
 
+std::vector<ImageReport> ProcessingOrchestrator::takeImageReports() {
+    std::lock_guard<std::mutex> lock(m_reportMutex);
+    return std::move(m_imageReports);
+}
 
-bool ProcessingOrchestrator::processImageFile(const std::filesystem::path& imagePath, const std::filesystem::path& outputSubDirPath) {
-    std::cout << "\n==================================================" << std::endl;
-    std::cout << "Processing IMAGE: " << imagePath.string() << std::endl;
-    std::cout << "Output SubDir:  " << outputSubDirPath.string() << std::endl;
-    std::cout << "==================================================" << std::endl;
+long ProcessingOrchestrator::addImageReport(ImageReport&& report) {
+    if (!m_collectReports) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(m_reportMutex);
+    m_imageReports.push_back(std::move(report));
+    return static_cast<long>(m_imageReports.size()) - 1;
+}
+
+void ProcessingOrchestrator::markReportFailed(long index, const std::string& error) {
+    if (index < 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_reportMutex);
+    ImageReport& report = m_imageReports[static_cast<size_t>(index)];
+    report.status = "failed";
+    report.error = error;
+}
+
+ProcessingOrchestrator::ImageTaskResult ProcessingOrchestrator::processImageFile(const std::filesystem::path& imagePath, const std::filesystem::path& outputSubDirPath,
+                                                                                 const std::vector<unsigned char>* inMemoryBytes) {
+    Trace::Span imageSpan("image"); // 在阶段收集之外：它的耗时就是 totalMs
+    if (imageSpan.active() && Trace::isEnabled()) {
+        imageSpan.setDetail(imagePath.filename().string());
+    }
+    if (!m_collectReports) {
+        return convertAndRender(imagePath, outputSubDirPath, inMemoryBytes);
+    }
+
+    // 本线程上结束的 Span 都计入这张图片的阶段耗时
+    Trace::StageTimes stageTimes;
+    ImageTaskResult result;
+    auto start = steady_clock::now();
+    {
+        Trace::ScopedStageTimes collectStages(&stageTimes);
+        Log::clearThreadError();
+        BufferPool::resetThreadPeak();
+        result = convertAndRender(imagePath, outputSubDirPath, inMemoryBytes);
+    }
+    ImageReport& report = result.report;
+    report.totalMs = duration<double, std::milli>(steady_clock::now() - start).count();
+    for (const auto& stage : stageTimes.totalsNs) {
+        report.stageMs.emplace_back(stage.first, stage.second / 1e6);
+    }
+    if (!result.success) {
+        report.error = Log::getThreadError();
+    }
+
+    std::error_code ec;
+    report.bytesRead = inMemoryBytes ? inMemoryBytes->size() : std::filesystem::file_size(imagePath, ec);
+    if (ec) {
+        report.bytesRead = 0;
+    }
+    uint64_t largestOutput = 0;
+    for (const auto& output : report.outputs) {
+        largestOutput = std::max(largestOutput, output.second);
+    }
+    report.peakMemoryBytes = report.bytesRead + BufferPool::getThreadPeakSinceReset() + largestOutput
+        + static_cast<uint64_t>(report.gridColumns) * report.gridRows * sizeof(CharColorInfo);
+
+    const AllocationTracker::Scope& allocations = imageSpan.allocations();
+    if (allocations.active()) {
+        report.allocationsTracked = true;
+        report.allocations = allocations.getAllocations();
+        report.allocatedBytes = allocations.getBytes();
+        report.peakLiveBytes = allocations.getPeakLiveBytes();
+    }
+    return result;
+}
+
+ProcessingOrchestrator::ImageTaskResult ProcessingOrchestrator::convertAndRender(const std::filesystem::path& imagePath, const std::filesystem::path& outputSubDirPath,
+                                                                                 const std::vector<unsigned char>* inMemoryBytes) {
+    LOG_DEBUG << "Processing IMAGE: " << imagePath.string() << " -> " << outputSubDirPath.string();
 
     auto proc_start = high_resolution_clock::now();
+    ImageTaskResult taskResult;
 
-    auto conversionResultOpt = convertImageToAscii(imagePath, m_config.targetWidth, m_config.charAspectRatioCorrection);
+    const bool isRenderOnly = isAsciiGridFile(imagePath);
+    std::optional<AsciiConversionResult> conversionResultOpt;
+    if (isRenderOnly) {
+        // 预先保存的网格：直接映射读取，跳过解码和转换
+        LOG_DEBUG << "Loading ASCII grid " << imagePath.filename().string() << " (render-only)...";
+        TRACE_SPAN("load grid");
+        conversionResultOpt = loadAsciiGridFile(imagePath);
+    } else if (m_cache && m_cache->isEnabled()) {
+        // 源文件只映射一次：既用于计算缓存键，未命中时也直接从映射解码
+        MappedFile mappedSource;
+        const unsigned char* sourceData = nullptr;
+        size_t sourceSize = 0;
+        if (inMemoryBytes) {
+            sourceData = inMemoryBytes->data();
+            sourceSize = inMemoryBytes->size();
+        } else {
+            TRACE_SPAN("load");
+            if (mappedSource.open(imagePath, MappedFile::Access::Sequential)) {
+                sourceData = mappedSource.data();
+                sourceSize = mappedSource.size();
+            }
+        }
+        if (sourceSize > 0) {
+            uint64_t sourceHash = 0;
+            {
+                TRACE_SPAN("hash");
+                sourceHash = ContentHash::hashBytes(sourceData, sourceSize);
+            }
+            uint64_t cacheKey = ConversionCache::makeKey(sourceHash, m_config.targetWidth, m_config.charAspectRatioCorrection);
+            {
+                TRACE_SPAN("cache lookup");
+                conversionResultOpt = m_cache->lookup(cacheKey);
+            }
+            if (conversionResultOpt) {
+                LOG_DEBUG << "Conversion cache hit for " << imagePath.filename().string();
+            } else {
+                conversionResultOpt = convertImageBytesToAscii(sourceData, sourceSize, imagePath.filename().string(),
+                                                               m_config.targetWidth, m_config.charAspectRatioCorrection);
+                if (conversionResultOpt) {
+                    conversionResultOpt->sourceHash = sourceHash;
+                    TRACE_SPAN("cache store");
+                    m_cache->store(cacheKey, *conversionResultOpt);
+                }
+            }
+        }
+    } else if (inMemoryBytes) {
+        conversionResultOpt = convertImageBytesToAscii(inMemoryBytes->data(), inMemoryBytes->size(), imagePath.filename().string(),
+                                                       m_config.targetWidth, m_config.charAspectRatioCorrection);
+    } else {
+        conversionResultOpt = convertImageToAscii(imagePath, m_config.targetWidth, m_config.charAspectRatioCorrection);
+    }
 
     if (!conversionResultOpt) {
-        std::cerr << "-> Skipping image " << imagePath.filename().string() << " due to conversion failure." << std::endl;
-        return false;
+        LOG_ERROR << "-> Skipping image " << imagePath.filename().string() << " due to conversion failure.";
+        return taskResult;
+    }
+
+    if (m_config.writeAsciiGrid && !isRenderOnly) {
+        if (conversionResultOpt->sourceHash == 0) {
+            conversionResultOpt->sourceHash = inMemoryBytes ? ContentHash::hashBytes(inMemoryBytes->data(), inMemoryBytes->size())
+                                                            : ContentHash::hashFile(imagePath).value_or(0);
+        }
+        std::filesystem::path gridOutputPath = outputSubDirPath / (imagePath.stem().string() + ASCII_GRID_EXTENSION);
+        LOG_DEBUG << "    -> agrid: " << gridOutputPath.filename().string();
+        std::vector<unsigned char> gridBytes;
+        if (!serializeAsciiGrid(*conversionResultOpt, gridBytes)
+            || !writeOutput(gridOutputPath, [&](OutputSink& sink) { return sink.write(gridBytes.data(), gridBytes.size()); },
+                            taskResult)) {
+            LOG_WARN << "Warning: Failed to save ASCII grid for " << imagePath.filename().string() << ".";
+        }
+    }
+    if (!isRenderOnly) {
+        taskResult.sourceHash = conversionResultOpt->sourceHash;
     }
 
     const auto& conversionResult = *conversionResultOpt;
+    taskResult.report.width = conversionResult.originalWidth;
+    taskResult.report.height = conversionResult.originalHeight;
+    taskResult.report.gridColumns = conversionResult.asciiWidth;
+    taskResult.report.gridRows = conversionResult.asciiHeight;
 
     if (m_config.schemesToGenerate.empty()) {
-        std::cerr << "Error: No color schemes configured to generate for " << imagePath.filename().string() << ". Skipping rendering." << std::endl;
-        return false;
+        LOG_ERROR << "Error: No color schemes configured to generate for " << imagePath.filename().string() << ". Skipping rendering.";
+        return taskResult;
     }
-    std::cout << "Processing " << m_config.schemesToGenerate.size() << " configured color scheme(s)..." << std::endl;
+    LOG_DEBUG << "Processing " << m_config.schemesToGenerate.size() << " configured color scheme(s)...";
 
     bool allOutputsSuccessful = true;
     for (const auto& currentScheme : m_config.schemesToGenerate) {
         std::string schemeSuffix = getSchemeSuffix(currentScheme);
         std::string baseNameForOutput = imagePath.stem().string() + schemeSuffix;
 
-        std::cout << "  Processing scheme: " << colorSchemeToString(currentScheme) << std::endl;
+        LOG_DEBUG << "  Processing scheme: " << colorSchemeToString(currentScheme);
 
         for (const auto& renderer : m_renderers) {
             std::string outputFilename = baseNameForOutput + renderer->getOutputFileExtension();
             std::filesystem::path finalOutputPath = outputSubDirPath / outputFilename;
 
-            std::cout << "    -> " << renderer->getOutputFileExtension().substr(1) << ": " << finalOutputPath.filename().string() << std::endl;
-
-            if (!renderer->render(conversionResult.data, finalOutputPath, m_config, currentScheme)) {
-                std::cerr << "    Error: Failed to render/save " << renderer->getOutputFileExtension() << " for scheme " << colorSchemeToString(currentScheme) << "." << std::endl;
+            LOG_DEBUG << "    -> " << renderer->getOutputFileExtension().substr(1) << ": " << finalOutputPath.filename().string();
+            TRACE_SPAN_DETAIL("render", colorSchemeToString(currentScheme) + " " + renderer->getOutputFileExtension());
+            const bool rendered = writeOutput(finalOutputPath, [&](OutputSink& sink) {
+                return renderer->render(conversionResult.data, sink, m_config, currentScheme);
+            }, taskResult);
+            if (!rendered) {
+                LOG_ERROR << "    Error: Failed to render/save " << renderer->getOutputFileExtension() << " for scheme " << colorSchemeToString(currentScheme) << ".";
                 allOutputsSuccessful = false;
             }
         }
     }
 
     auto proc_end = high_resolution_clock::now();
-    std::cout << "-> Finished IMAGE processing '" << imagePath.filename().string() << "'. Time: "
-         << std::fixed << std::setprecision(3) << duration_cast<milliseconds>(proc_end - proc_start).count() / 1000.0 << "s" << std::endl;
+    LOG_INFO << "-> Finished IMAGE processing '" << imagePath.filename().string() << "'. Time: "
+             << std::fixed << std::setprecision(3) << duration_cast<milliseconds>(proc_end - proc_start).count() / 1000.0 << "s";
 
-    return allOutputsSuccessful;
+    taskResult.success = allOutputsSuccessful;
+    return taskResult;
 }
\ No newline at end of file
@@ -3,30 +3,106 @@
 
 #include "common/common_types.h"
 #include "rendering/IRenderer.h"
+#include "conversion_cache.h"
+#include "thread_pool.h"
+#include "archive_output_writer.h"
+#include "utils/AsyncFileWriter.h"
+#include "run_report.h"
+#include <atomic>
 #include <filesystem>
+#include <functional>
+#include <istream>
+#include <mutex>
+#include <string>
 #include <vector>
 #include <memory>
 
+class ProgressReporter;
+
 class ProcessingOrchestrator {
 public:
     ProcessingOrchestrator(const Config& config);
     void process(const std::filesystem::path& inputPath);
+    // 按行（或 NUL）读取路径列表，读到一个就提交一个；输出写入当前目录下的 <listName>_<width>_ascii_batch_output
+    void processFileList(std::istream& listStream, bool nulSeparated, const std::string& listName);
+    // 只处理相对路径哈希落在本分片的输入；分片时清单和汇总按分片单独写入
+    void setShard(const ShardSpec& shard) { m_shard = shard; }
+    // 批处理时向 progress 报告排队、开始和完成的输入；由调用方持有，处理期间保持有效
+    void setProgressReporter(ProgressReporter* progress) { m_progress = progress; }
 
     int getProcessedCount() const { return m_processedCount; }
     int getFailedCount() const { return m_failedCount; }
+    ProcessingStats getStats() const;
     const std::filesystem::path& getFinalOutputDir() const { return m_finalMainOutputDirPath; }
+    size_t getWorkerThreadCount() const { return m_pool ? m_pool->getThreadCount() : 1; }
+
+    // --report：为每个输入记录尺寸、各阶段耗时、读写字节数和失败原因
+    void enableImageReports() { m_collectReports = true; }
+    std::vector<ImageReport> takeImageReports();
 
 private:
     void setupRenderers();
     void processSingleImage(const std::filesystem::path& imagePath);
     void processDirectory(const std::filesystem::path& dirPath);
-    bool processImageFile(const std::filesystem::path& imagePath, const std::filesystem::path& outputSubDirPath);
+    // 顺序读取 tar 归档，条目内容直接在内存中解码，输出结构与目录输入相同
+    void processArchive(const std::filesystem::path& archivePath);
+
+    // 批处理状态：枚举线程提交输入，工作线程池并发处理，结束后统一链接重复项并保存清单
+    struct BatchInput;
+    struct BatchRun;
+    void beginBatch(BatchRun& run);
+    void enumerateDirectory(BatchRun& run, const std::filesystem::path& dirPath);
+    void submitBatchInput(BatchRun& run, const std::filesystem::path& inputPath, const std::filesystem::path& relativePath);
+    void admitBatchInput(BatchRun& run, BatchInput&& input);
+    bool isInShard(const std::filesystem::path& relativePath) const;
+    uint64_t getInputHash(BatchInput& input);
+    long findDuplicateInput(BatchRun& run, size_t index);
+    void runBatchTask(BatchRun& run, BatchInput& input);
+    void finishBatch(BatchRun& run);
+    ThreadPool& getWorkerPool();
+
+    struct ImageTaskResult {
+        bool success = false;
+        uint64_t sourceHash = 0; // ContentHash of the input, 0 if it was not computed
+        std::vector<std::filesystem::path> outputs;
+        // 输出由异步写线程写出，写入失败时在完成回调中置位；只有 drain 之后才是最终结果
+        std::shared_ptr<std::atomic<bool>> writeFailed = std::make_shared<std::atomic<bool>>(false);
+        ImageReport report; // 尺寸总是填写；输出大小、耗时等只在 --report 时填写
+    };
+
+    // 写出一个输出文件：内容先在内存中生成，普通模式交给异步文件写入器，归档模式交给归档写线程。
+    // 成功交出后把路径记入 result.outputs
+    bool writeOutput(const std::filesystem::path& outputPath, const std::function<bool(OutputSink&)>& produce,
+                     ImageTaskResult& result);
+    AsyncFileWriter& getFileWriter();
+
+    // inMemoryBytes 非空时从内存解码，imagePath 只用于命名和日志。
+    // 启用报告时在 convertAndRender 外收集阶段耗时、内存峰值和失败原因
+    ImageTaskResult processImageFile(const std::filesystem::path& imagePath, const std::filesystem::path& outputSubDirPath,
+                                     const std::vector<unsigned char>* inMemoryBytes = nullptr);
+    ImageTaskResult convertAndRender(const std::filesystem::path& imagePath, const std::filesystem::path& outputSubDirPath,
+                                     const std::vector<unsigned char>* inMemoryBytes);
+    // 返回记录的下标，未启用报告时返回 -1
+    long addImageReport(ImageReport&& report);
+    void markReportFailed(long index, const std::string& error);
 
     const Config& m_config;
-    int m_processedCount = 0;
-    int m_failedCount = 0;
+    ShardSpec m_shard;
+    ProgressReporter* m_progress = nullptr;
+    std::atomic<int> m_processedCount{0};
+    std::atomic<int> m_failedCount{0};
+    std::atomic<int> m_unchangedCount{0};
+    std::atomic<int> m_duplicateCount{0};
     std::filesystem::path m_finalMainOutputDirPath;
     std::vector<std::unique_ptr<IRenderer>> m_renderers;
+    std::unique_ptr<ConversionCache> m_cache; // nullptr when conversionCacheDir is empty
+    std::unique_ptr<ThreadPool> m_pool;       // created on first batch, sized by workerThreads
+    std::unique_ptr<ArchiveOutputWriter> m_archiveWriter; // non-null during a batch with archiveBatchOutputs
+    std::unique_ptr<AsyncFileWriter> m_fileWriter;        // created on the first output written as a file
+    std::once_flag m_fileWriterOnce;
+    bool m_collectReports = false;
+    std::mutex m_reportMutex;              // 工作线程和枚举线程都会添加记录
+    std::vector<ImageReport> m_imageReports;
 };
 
 #endif // PROCESSING_ORCHESTRATOR_H
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "progress_reporter.h"
+#include "utils/Logger.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+
+using json = nlohmann::json;
+using namespace std::chrono;
+
+namespace {
+
+// 速率按最近一段时间计算：长时间运行中途变慢（例如换到大图目录）时预计时间能跟上
+constexpr auto RATE_WINDOW = seconds(30);
+// 非终端输出时进度日志的间隔
+constexpr auto LOG_INTERVAL = seconds(10);
+
+std::string formatDuration(double totalSeconds) {
+    const long long secondsLeft = static_cast<long long>(totalSeconds + 0.5);
+    char buffer[32];
+    if (secondsLeft >= 3600) {
+        std::snprintf(buffer, sizeof(buffer), "%lldh%02lldm", secondsLeft / 3600, secondsLeft % 3600 / 60);
+    } else if (secondsLeft >= 60) {
+        std::snprintf(buffer, sizeof(buffer), "%lldm%02llds", secondsLeft / 60, secondsLeft % 60);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%llds", secondsLeft);
+    }
+    return buffer;
+}
+
+} // end anonymous namespace
+
+ProgressReporter::ProgressReporter(const Options& options) : m_options(options) {}
+
+ProgressReporter::~ProgressReporter() {
+    stop();
+}
+
+void ProgressReporter::start() {
+    m_startTime = steady_clock::now();
+    m_lastLogTime = m_startTime;
+    m_samples.push_back({m_startTime, 0, 0});
+    m_thread = std::thread(&ProgressReporter::refreshLoop, this);
+}
+
+void ProgressReporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping || !m_thread.joinable()) return;
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+
+    const Snapshot snapshot = takeSnapshot(steady_clock::now());
+    if (m_options.statusLine) {
+        Log::setStatusLine(std::string());
+    }
+    if (!m_options.statusFile.empty()) {
+        writeStatusFile(snapshot, "finished");
+    }
+}
+
+void ProgressReporter::onFinished(bool success, uint64_t pixels) {
+    if (!success) {
+        m_failed.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_pixels.fetch_add(pixels, std::memory_order_relaxed);
+    m_lastCompletionNs.store(duration_cast<nanoseconds>(steady_clock::now() - m_startTime).count(), std::memory_order_relaxed);
+    m_finished.fetch_add(1, std::memory_order_release);
+}
+
+void ProgressReporter::refreshLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_wake.wait_for(lock, m_options.interval, [this] { return m_stopping; })) {
+        lock.unlock();
+        const auto now = steady_clock::now();
+        const Snapshot snapshot = takeSnapshot(now);
+        if (m_options.statusLine) {
+            Log::setStatusLine(formatLine(snapshot));
+        } else if (m_options.logLines && now - m_lastLogTime >= LOG_INTERVAL) {
+            m_lastLogTime = now;
+            LOG_INFO << "Progress: " << formatLine(snapshot);
+        }
+        if (!m_options.statusFile.empty()) {
+            writeStatusFile(snapshot, "running");
+        }
+        lock.lock();
+    }
+}
+
+ProgressReporter::Snapshot ProgressReporter::takeSnapshot(steady_clock::time_point now) {
+    // 计数器单调递增，按 finished -> started -> queued 的顺序读取，差值不会为负
+    const uint64_t finished = m_finished.load(std::memory_order_acquire);
+    const uint64_t pixels = m_pixels.load(std::memory_order_relaxed);
+    const uint64_t started = m_started.load(std::memory_order_relaxed);
+    const uint64_t queued = m_queued.load(std::memory_order_relaxed);
+
+    Snapshot snapshot;
+    snapshot.queued = queued - started;
+    snapshot.inFlight = started - finished;
+    snapshot.completed = finished;
+    snapshot.failed = m_failed.load(std::memory_order_relaxed);
+    snapshot.skipped = m_skipped.load(std::memory_order_relaxed);
+    snapshot.totalKnown = m_enumerationComplete.load(std::memory_order_relaxed);
+    snapshot.total = queued + snapshot.skipped;
+    snapshot.elapsedSeconds = duration<double>(now - m_startTime).count();
+    const int64_t lastCompletionNs = m_lastCompletionNs.load(std::memory_order_relaxed);
+    if (lastCompletionNs > 0) {
+        snapshot.secondsSinceLastCompletion = std::max(0.0, snapshot.elapsedSeconds - lastCompletionNs / 1e9);
+    }
+
+    m_samples.push_back({now, finished, pixels});
+    while (m_samples.size() > 2 && now - m_samples[1].time >= RATE_WINDOW) {
+        m_samples.pop_front();
+    }
+    const Sample& oldest = m_samples.front();
+    const double windowSeconds = duration<double>(now - oldest.time).count();
+    if (windowSeconds > 0.0) {
+        snapshot.imagesPerSecond = (finished - oldest.finished) / windowSeconds;
+        snapshot.megapixelsPerSecond = (pixels - oldest.pixels) / 1e6 / windowSeconds;
+    }
+    if (snapshot.totalKnown && snapshot.imagesPerSecond > 0.0) {
+        snapshot.etaSeconds = (queued - finished) / snapshot.imagesPerSecond;
+    } else if (snapshot.totalKnown && queued == finished) {
+        snapshot.etaSeconds = 0.0;
+    }
+    return snapshot;
+}
+
+std::string ProgressReporter::formatLine(const Snapshot& snapshot) const {
+    const uint64_t done = snapshot.completed + snapshot.skipped;
+    char buffer[256];
+    int length;
+    if (snapshot.totalKnown) {
+        const double percent = snapshot.total > 0 ? 100.0 * done / snapshot.total : 100.0;
+        length = std::snprintf(buffer, sizeof(buffer), "[%llu/%llu %5.1f%%]", static_cast<unsigned long long>(done),
+                               static_cast<unsigned long long>(snapshot.total), percent);
+    } else {
+        length = std::snprintf(buffer, sizeof(buffer), "[%llu, scanning]", static_cast<unsigned long long>(done));
+    }
+    std::string line(buffer, static_cast<size_t>(length));
+    length = std::snprintf(buffer, sizeof(buffer), " %llu running, %llu queued", static_cast<unsigned long long>(snapshot.inFlight),
+                           static_cast<unsigned long long>(snapshot.queued));
+    line.append(buffer, static_cast<size_t>(length));
+    if (snapshot.failed > 0) {
+        length = std::snprintf(buffer, sizeof(buffer), ", %llu failed", static_cast<unsigned long long>(snapshot.failed));
+        line.append(buffer, static_cast<size_t>(length));
+    }
+    length = std::snprintf(buffer, sizeof(buffer), " | %.1f img/s, %.1f MP/s", snapshot.imagesPerSecond, snapshot.megapixelsPerSecond);
+    line.append(buffer, static_cast<size_t>(length));
+    if (snapshot.etaSeconds >= 0.0) {
+        line += " | ETA " + formatDuration(snapshot.etaSeconds);
+    }
+    line += " | " + formatDuration(snapshot.elapsedSeconds) + " elapsed";
+    return line;
+}
+
+void ProgressReporter::writeStatusFile(const Snapshot& snapshot, const char* state) {
+    json j;
+    j["state"] = state;
+    j["updatedAt"] = static_cast<int64_t>(std::time(nullptr)); // 与当前时间比较可发现已退出的进程
+    j["elapsedSeconds"] = snapshot.elapsedSeconds;
+    j["completed"] = snapshot.completed;
+    j["failed"] = snapshot.failed;
+    j["skipped"] = snapshot.skipped;
+    j["inFlight"] = snapshot.inFlight;
+    j["queued"] = snapshot.queued;
+    j["totalKnown"] = snapshot.totalKnown;
+    j["total"] = snapshot.total;
+    j["imagesPerSecond"] = snapshot.imagesPerSecond;
+    j["megapixelsPerSecond"] = snapshot.megapixelsPerSecond;
+    j["etaSeconds"] = snapshot.etaSeconds >= 0.0 ? json(snapshot.etaSeconds) : json(nullptr);
+    j["secondsSinceLastCompletion"] = snapshot.secondsSinceLastCompletion >= 0.0 ? json(snapshot.secondsSinceLastCompletion) : json(nullptr);
+
+    // 先写临时文件再改名：读取方不会看到写了一半的内容
+    std::filesystem::path tmpPath = m_options.statusFile;
+    tmpPath += ".tmp";
+    bool written = false;
+    {
+        std::ofstream file(tmpPath, std::ios::trunc);
+        if (file.is_open()) {
+            file << j.dump(1) << '\n';
+            written = static_cast<bool>(file);
+        }
+    }
+    std::error_code ec;
+    if (written) {
+        std::filesystem::rename(tmpPath, m_options.statusFile, ec);
+    }
+    if ((!written || ec) && !m_statusFileFailed) {
+        m_statusFileFailed = true; // 每秒都会重试，只警告一次
+        LOG_WARN << "Warning: Cannot write status file '" << m_options.statusFile.string() << "'.";
+    }
+}
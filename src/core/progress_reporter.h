@@ -0,0 +1,94 @@
+#ifndef PROGRESS_REPORTER_H
+#define PROGRESS_REPORTER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// 批处理进度（--progress、--status-file）。工作线程和枚举线程只更新原子计数器；
+// 一个刷新线程定期汇总：在终端上重绘状态行（已完成/处理中/排队中、图片/s、MP/s、预计剩余时间），
+// 并原子地重写 JSON 状态文件，外部工具据此判断任务是否停滞，而不必解析交错的日志。
+class ProgressReporter {
+public:
+    struct Options {
+        bool statusLine = false;              // 终端状态行（标准错误是终端时）
+        bool logLines = false;                // 否则每 LOG_INTERVAL 写一条 Info 日志
+        std::filesystem::path statusFile;     // 为空时不写
+        std::chrono::milliseconds interval{1000};
+    };
+
+    explicit ProgressReporter(const Options& options);
+    ~ProgressReporter();
+
+    ProgressReporter(const ProgressReporter&) = delete;
+    ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+    void start();
+    // 写出最终状态（state 为 finished）并清除状态行
+    void stop();
+
+    // 输入已提交到线程池 / 被工作线程取出 / 处理结束（pixels 为源图片像素数，失败时可为 0）
+    void onQueued() { m_queued.fetch_add(1, std::memory_order_relaxed); }
+    void onStarted() { m_started.fetch_add(1, std::memory_order_relaxed); }
+    void onFinished(bool success, uint64_t pixels);
+    // 未经处理的输入（未变化、重复），计入总数
+    void onSkipped() { m_skipped.fetch_add(1, std::memory_order_relaxed); }
+    // 枚举结束，总数已知：之后才给出百分比和预计剩余时间
+    void setEnumerationComplete() { m_enumerationComplete.store(true, std::memory_order_relaxed); }
+
+private:
+    struct Sample {
+        std::chrono::steady_clock::time_point time;
+        uint64_t finished;
+        uint64_t pixels;
+    };
+
+    struct Snapshot {
+        uint64_t queued = 0;      // 在线程池队列中等待
+        uint64_t inFlight = 0;
+        uint64_t completed = 0;   // 处理结束（成功和失败）
+        uint64_t failed = 0;
+        uint64_t skipped = 0;
+        bool totalKnown = false;
+        uint64_t total = 0;
+        double elapsedSeconds = 0.0;
+        double imagesPerSecond = 0.0;     // 最近 RATE_WINDOW 内的速率
+        double megapixelsPerSecond = 0.0;
+        double etaSeconds = -1.0;         // 未知时为负
+        double secondsSinceLastCompletion = -1.0;
+    };
+
+    void refreshLoop();
+    Snapshot takeSnapshot(std::chrono::steady_clock::time_point now);
+    std::string formatLine(const Snapshot& snapshot) const;
+    void writeStatusFile(const Snapshot& snapshot, const char* state);
+
+    const Options m_options;
+    std::atomic<uint64_t> m_queued{0};
+    std::atomic<uint64_t> m_started{0};
+    std::atomic<uint64_t> m_finished{0};
+    std::atomic<uint64_t> m_failed{0};
+    std::atomic<uint64_t> m_skipped{0};
+    std::atomic<uint64_t> m_pixels{0};
+    std::atomic<int64_t> m_lastCompletionNs{0}; // 相对 m_startTime；0 表示还没有完成的输入
+    std::atomic<bool> m_enumerationComplete{false};
+
+    // 以下只由刷新线程（以及 stop() 之后的调用线程）访问
+    std::chrono::steady_clock::time_point m_startTime;
+    std::chrono::steady_clock::time_point m_lastLogTime;
+    std::deque<Sample> m_samples;
+    bool m_statusFileFailed = false;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+    std::thread m_thread;
+};
+
+#endif // PROGRESS_REPORTER_H
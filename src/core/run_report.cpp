@@ -0,0 +1,379 @@
+#include "run_report.h"
+#include "batch_manifest.h"
+#include "utils/Logger.h"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <regex>
+#include <system_error>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int REPORT_VERSION = 1;
+
+json statsToJson(const ProcessingStats& stats) {
+    return {
+        {"processed", stats.processedCount},
+        {"failed", stats.failedCount},
+        {"unchanged", stats.unchangedCount},
+        {"duplicates", stats.duplicateCount},
+        {"cacheHits", stats.cacheHits},
+        {"cacheMisses", stats.cacheMisses}
+    };
+}
+
+ProcessingStats statsFromJson(const json& j) {
+    ProcessingStats stats;
+    stats.processedCount = j.value("processed", 0);
+    stats.failedCount = j.value("failed", 0);
+    stats.unchangedCount = j.value("unchanged", 0);
+    stats.duplicateCount = j.value("duplicates", 0);
+    stats.cacheHits = j.value("cacheHits", 0);
+    stats.cacheMisses = j.value("cacheMisses", 0);
+    stats.cacheEnabled = stats.cacheHits + stats.cacheMisses > 0;
+    return stats;
+}
+
+constexpr double BYTES_PER_MB = 1024.0 * 1024.0;
+
+// 最近秩法分位数；values 已排序且非空
+double percentile(const std::vector<double>& values, double p) {
+    const size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * values.size()));
+    return values[std::min(values.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+json distributionToJson(std::vector<double> values) {
+    if (values.empty()) {
+        return json::object();
+    }
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (double value : values) {
+        sum += value;
+    }
+    return {
+        {"count", values.size()},
+        {"mean", sum / values.size()},
+        {"p50", percentile(values, 50)},
+        {"p90", percentile(values, 90)},
+        {"p95", percentile(values, 95)},
+        {"p99", percentile(values, 99)},
+        {"max", values.back()},
+        {"total", sum}
+    };
+}
+
+json imageToJson(const ImageReport& image) {
+    json j = {
+        {"input", image.input},
+        {"status", image.status}
+    };
+    if (!image.error.empty()) {
+        j["error"] = image.error;
+    }
+    if (image.width > 0) {
+        j["width"] = image.width;
+        j["height"] = image.height;
+    }
+    if (image.gridColumns > 0) {
+        j["gridColumns"] = image.gridColumns;
+        j["gridRows"] = image.gridRows;
+    }
+    uint64_t bytesWritten = 0;
+    json outputs = json::array();
+    for (const auto& output : image.outputs) {
+        outputs.push_back({{"path", output.first}, {"bytes", output.second}});
+        bytesWritten += output.second;
+    }
+    j["bytesRead"] = image.bytesRead;
+    j["bytesWritten"] = bytesWritten;
+    j["outputs"] = std::move(outputs);
+    if (image.totalMs > 0.0) {
+        j["totalMs"] = image.totalMs;
+        j["peakMemoryEstimateBytes"] = image.peakMemoryBytes;
+        json stages = json::object();
+        for (const auto& stage : image.stageMs) {
+            stages[stage.first] = stage.second;
+        }
+        j["stagesMs"] = std::move(stages);
+    }
+    if (image.allocationsTracked) {
+        j["allocations"] = {
+            {"count", image.allocations},
+            {"bytes", image.allocatedBytes},
+            {"peakLiveBytes", image.peakLiveBytes}
+        };
+    }
+    return j;
+}
+
+json allocationsToJson(const RunReport& report) {
+    json stages = json::object();
+    for (const auto& totals : report.allocationStages) {
+        stages[totals.stage] = {
+            {"activations", totals.activations},
+            {"count", totals.allocations},
+            {"bytes", totals.bytes},
+            {"peakLiveBytes", totals.peakLiveBytes}
+        };
+    }
+    // 阶段按包含关系统计（render 包含 rasterize 和 encode png），各阶段之和大于总数
+    return {
+        {"totalCount", report.totalAllocations},
+        {"totalBytes", report.totalAllocatedBytes},
+        {"inclusive", true},
+        {"stages", std::move(stages)}
+    };
+}
+
+json perfCountersToJson(const RunReport& report) {
+    if (!report.perfCountersError.empty()) {
+        return {{"available", false}, {"error", report.perfCountersError}};
+    }
+    static const char* const names[PerfCounters::COUNTER_COUNT] = {"cycles", "instructions", "cacheMisses", "branchMisses"};
+    json stages = json::object();
+    for (const auto& totals : report.perfCounters) {
+        json stage = {{"samples", totals.samples}};
+        for (size_t i = 0; i < PerfCounters::COUNTER_COUNT; ++i) {
+            if (totals.available[i]) {
+                stage[names[i]] = totals.values[i];
+            }
+        }
+        const uint64_t cycles = totals.values[PerfCounters::CYCLES];
+        if (totals.available[PerfCounters::CYCLES] && totals.available[PerfCounters::INSTRUCTIONS] && cycles > 0) {
+            stage["ipc"] = static_cast<double>(totals.values[PerfCounters::INSTRUCTIONS]) / cycles;
+        }
+        if (totals.available[PerfCounters::INSTRUCTIONS] && totals.values[PerfCounters::INSTRUCTIONS] > 0) {
+            const double kiloInstructions = totals.values[PerfCounters::INSTRUCTIONS] / 1000.0;
+            if (totals.available[PerfCounters::CACHE_MISSES]) {
+                stage["cacheMissesPerKiloInstruction"] = totals.values[PerfCounters::CACHE_MISSES] / kiloInstructions;
+            }
+            if (totals.available[PerfCounters::BRANCH_MISSES]) {
+                stage["branchMissesPerKiloInstruction"] = totals.values[PerfCounters::BRANCH_MISSES] / kiloInstructions;
+            }
+        }
+        stages[totals.stage] = std::move(stage);
+    }
+    return {{"available", true}, {"scope", "user"}, {"stages", std::move(stages)}};
+}
+
+bool writeJsonAtomically(const fs::path& path, const json& j) {
+    fs::path tmpPath = path;
+    tmpPath += ".tmp";
+    {
+        std::ofstream file(tmpPath);
+        if (!file.is_open()) {
+            LOG_ERROR << "Error: Could not open report for writing: " << tmpPath.string();
+            return false;
+        }
+        // 报告中的路径可能不是合法的 UTF-8，替换而不是抛出异常
+        file << j.dump(1, ' ', false, json::error_handler_t::replace) << std::endl;
+        if (!file) {
+            LOG_ERROR << "Error: Failed to write report: " << tmpPath.string();
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmpPath, path, ec);
+    if (ec) {
+        LOG_ERROR << "Error: Failed to replace '" << path.string() << "': " << ec.message();
+        return false;
+    }
+    return true;
+}
+
+} // end anonymous namespace
+
+bool writeShardReport(const fs::path& reportPath, const ShardReport& report) {
+    json j;
+    j["version"] = REPORT_VERSION;
+    j["shard"] = {{"index", report.shard.index}, {"count", report.shard.count}};
+    j["configFingerprint"] = report.configFingerprint;
+    j["durationSeconds"] = report.durationSeconds;
+    j["stats"] = statsToJson(report.stats);
+    return writeJsonAtomically(reportPath, j);
+}
+
+std::optional<ShardReport> loadShardReport(const fs::path& reportPath) {
+    std::ifstream file(reportPath);
+    if (!file.is_open()) {
+        LOG_ERROR << "Error: Cannot open shard report: " << reportPath.string();
+        return std::nullopt;
+    }
+    try {
+        json j;
+        file >> j;
+        if (j.value("version", 0) != REPORT_VERSION) {
+            LOG_ERROR << "Error: Unsupported shard report version: " << reportPath.string();
+            return std::nullopt;
+        }
+        ShardReport report;
+        const json shard = j.value("shard", json::object());
+        report.shard.index = shard.value("index", 0);
+        report.shard.count = shard.value("count", 1);
+        report.configFingerprint = j.value("configFingerprint", std::string());
+        report.durationSeconds = j.value("durationSeconds", 0.0);
+        report.stats = statsFromJson(j.value("stats", json::object()));
+        return report;
+    } catch (const std::exception& e) {
+        LOG_ERROR << "Error: Failed to parse shard report '" << reportPath.string() << "': " << e.what();
+        return std::nullopt;
+    }
+}
+
+bool mergeShardFragments(const fs::path& batchOutputDir, ProcessingStats& mergedStats, double& wallSeconds) {
+    const std::regex reportPattern(std::string(RUN_REPORT_BASENAME) + R"(\.shard-(\d+)-of-(\d+)\.json)");
+    std::map<int, ShardReport> reports;
+    int shardCount = 0;
+
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(batchOutputDir, ec)) {
+        std::smatch match;
+        const std::string name = entry.path().filename().string();
+        if (!std::regex_match(name, match, reportPattern)) continue;
+
+        auto report = loadShardReport(entry.path());
+        if (!report) return false;
+        if (shardCount != 0 && report->shard.count != shardCount) {
+            LOG_ERROR << "Error: Shard reports disagree on the shard count (" << shardCount << " vs " << report->shard.count << ").";
+            return false;
+        }
+        shardCount = report->shard.count;
+        reports[report->shard.index] = std::move(*report);
+    }
+    if (ec) {
+        LOG_ERROR << "Error: Cannot read directory " << batchOutputDir.string() << ": " << ec.message();
+        return false;
+    }
+    if (reports.empty()) {
+        LOG_ERROR << "Error: No shard reports found in " << batchOutputDir.string();
+        return false;
+    }
+
+    bool complete = true;
+    for (int i = 0; i < shardCount; ++i) {
+        if (!reports.count(i)) {
+            LOG_ERROR << "Error: Missing report for shard " << i << "/" << shardCount << ".";
+            complete = false;
+        }
+    }
+    if (!complete) return false;
+
+    const std::string& fingerprint = reports.begin()->second.configFingerprint;
+    mergedStats = ProcessingStats();
+    wallSeconds = 0.0;
+    json shardDurations = json::array();
+    for (const auto& kv : reports) {
+        const ShardReport& report = kv.second;
+        if (report.configFingerprint != fingerprint) {
+            LOG_WARN << "Warning: Shard " << kv.first << " was run with a different output configuration.";
+        }
+        mergedStats.processedCount += report.stats.processedCount;
+        mergedStats.failedCount += report.stats.failedCount;
+        mergedStats.unchangedCount += report.stats.unchangedCount;
+        mergedStats.duplicateCount += report.stats.duplicateCount;
+        mergedStats.cacheHits += report.stats.cacheHits;
+        mergedStats.cacheMisses += report.stats.cacheMisses;
+        mergedStats.cacheEnabled = mergedStats.cacheEnabled || report.stats.cacheEnabled;
+        wallSeconds = std::max(wallSeconds, report.durationSeconds);
+        shardDurations.push_back(report.durationSeconds);
+    }
+
+    json merged;
+    merged["version"] = REPORT_VERSION;
+    merged["shardCount"] = shardCount;
+    merged["configFingerprint"] = fingerprint;
+    merged["durationSeconds"] = wallSeconds;
+    merged["shardDurationSeconds"] = std::move(shardDurations);
+    merged["stats"] = statsToJson(mergedStats);
+    if (!writeJsonAtomically(batchOutputDir / (std::string(RUN_REPORT_BASENAME) + ".json"), merged)) {
+        return false;
+    }
+
+    // 增量模式下各分片的清单片段合并为一份，之后不分片的增量运行也能直接使用
+    BatchManifest mergedManifest;
+    mergedManifest.setConfigFingerprint(fingerprint);
+    bool anyManifest = false;
+    for (const auto& kv : reports) {
+        const fs::path fragmentPath = batchOutputDir / ("_manifest" + kv.second.shard.fileTag() + ".json");
+        BatchManifest fragment;
+        if (fragment.load(fragmentPath)) {
+            mergedManifest.mergeFrom(fragment);
+            anyManifest = true;
+        }
+    }
+    if (anyManifest && !mergedManifest.save(batchOutputDir / BatchManifest::FILENAME)) {
+        return false;
+    }
+    return true;
+}
+
+bool writeRunReport(const fs::path& reportPath, const RunReport& report) {
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+    double megapixels = 0.0;
+    std::vector<double> latencies;
+    std::vector<double> peakMemory;
+    std::map<std::string, std::vector<double>> stageValues;
+    json images = json::array();
+    for (const auto& image : report.images) {
+        images.push_back(imageToJson(image));
+        for (const auto& output : image.outputs) {
+            bytesWritten += output.second;
+        }
+        // 跳过和链接的输入没有经过处理，不计入吞吐量和延迟
+        if (image.totalMs <= 0.0) continue;
+        bytesRead += image.bytesRead;
+        latencies.push_back(image.totalMs);
+        peakMemory.push_back(static_cast<double>(image.peakMemoryBytes));
+        if (image.status == "processed") {
+            megapixels += static_cast<double>(image.width) * image.height / 1e6;
+        }
+        for (const auto& stage : image.stageMs) {
+            stageValues[stage.first].push_back(stage.second);
+        }
+    }
+
+    const double seconds = report.durationSeconds > 0.0 ? report.durationSeconds : 0.0;
+    auto perSecond = [seconds](double amount) { return seconds > 0.0 ? amount / seconds : 0.0; };
+
+    json stages = json::object();
+    for (auto& kv : stageValues) {
+        stages[kv.first] = distributionToJson(std::move(kv.second));
+    }
+
+    json j;
+    j["version"] = REPORT_VERSION;
+    j["durationSeconds"] = report.durationSeconds;
+    j["workerThreads"] = report.workerThreads;
+    j["stats"] = statsToJson(report.stats);
+    j["throughput"] = {
+        {"imagesPerSecond", perSecond(report.stats.processedCount)},
+        {"megapixelsPerSecond", perSecond(megapixels)},
+        {"inputMBPerSecond", perSecond(bytesRead / BYTES_PER_MB)},
+        {"outputMBPerSecond", perSecond(bytesWritten / BYTES_PER_MB)}
+    };
+    j["bytesRead"] = bytesRead;
+    j["bytesWritten"] = bytesWritten;
+    j["latencyMs"] = distributionToJson(std::move(latencies));
+    j["peakMemoryEstimateBytes"] = distributionToJson(std::move(peakMemory));
+    j["stagesMs"] = std::move(stages);
+    if (report.perfCountersRequested) {
+        j["perfCounters"] = perfCountersToJson(report);
+    }
+    if (report.allocationsTracked) {
+        j["allocations"] = allocationsToJson(report);
+    }
+    j["images"] = std::move(images);
+    if (!writeJsonAtomically(reportPath, j)) {
+        return false;
+    }
+    LOG_INFO << "Info: Wrote run report " << reportPath.string();
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef RUN_REPORT_H
+#define RUN_REPORT_H
+
+#include "common/common_types.h"
+#include "utils/AllocationTracker.h"
+#include "utils/PerfCounters.h"
+#include <filesystem>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 分片运行的汇总片段。每个分片在批处理输出目录中写入自己的 _report.shard-i-of-N.json，
+// merge 子命令再把所有片段合并为 _report.json（清单片段同时合并为 _manifest.json）。
+struct ShardReport {
+    ShardSpec shard;
+    ProcessingStats stats;
+    double durationSeconds = 0.0;
+    std::string configFingerprint;
+};
+
+constexpr const char* RUN_REPORT_BASENAME = "_report";
+
+// --report：每个输入一条记录
+struct ImageReport {
+    std::string input;
+    std::string status;        // processed / failed / unchanged / duplicate
+    std::string error;         // 失败时记录的第一条错误
+    int width = 0;             // 源图片尺寸
+    int height = 0;
+    int gridColumns = 0;
+    int gridRows = 0;
+    uint64_t bytesRead = 0;
+    uint64_t peakMemoryBytes = 0; // 估计值：输入 + 缓冲池峰值（解码/画布/编码）+ 网格 + 最大的输出
+    double totalMs = 0.0;
+    std::vector<std::pair<std::string, uint64_t>> outputs; // 路径和字节数
+    std::vector<std::pair<std::string, double>> stageMs;   // 各阶段耗时之和；render 包含 rasterize/encode
+    // --track-allocations：这张图片处理期间本线程的分配（次数、字节数、存活字节数的峰值增量）
+    bool allocationsTracked = false;
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+    uint64_t peakLiveBytes = 0;
+};
+
+struct RunReport {
+    ProcessingStats stats;
+    double durationSeconds = 0.0;
+    size_t workerThreads = 0;
+    std::vector<ImageReport> images;
+    // --perf-counters：请求时写出 perfCounters 段；不可用时只写出原因
+    bool perfCountersRequested = false;
+    std::string perfCountersError;
+    std::vector<PerfCounters::StageTotals> perfCounters;
+    // --track-allocations：按阶段的分配统计和整个进程的总数
+    bool allocationsTracked = false;
+    uint64_t totalAllocations = 0;
+    uint64_t totalAllocatedBytes = 0;
+    std::vector<AllocationTracker::StageTotals> allocationStages;
+};
+
+// 写出每个输入的指标，以及吞吐量（图片/s、MP/s、输出 MB/s）和延迟分位数
+bool writeRunReport(const std::filesystem::path& reportPath, const RunReport& report);
+
+bool writeShardReport(const std::filesystem::path& reportPath, const ShardReport& report);
+std::optional<ShardReport> loadShardReport(const std::filesystem::path& reportPath);
+
+// 所有分片都存在时合并并返回 true；mergedStats 为各分片计数之和，wallSeconds 为最慢分片的耗时
+bool mergeShardFragments(const std::filesystem::path& batchOutputDir, ProcessingStats& mergedStats, double& wallSeconds);
+
+#endif // RUN_REPORT_H
@@ -0,0 +1,82 @@
+#include "thread_pool.h"
+#include "utils/Logger.h"
+#include "utils/Trace.h"
+#include <string>
+#include <exception>
+
+ThreadPool::ThreadPool(size_t threadCount, size_t maxQueuedTasks) : m_maxQueuedTasks(maxQueuedTasks) {
+    if (threadCount == 0) {
+        threadCount = defaultThreadCount();
+    }
+    m_workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_taskAvailable.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::defaultThreadCount() {
+    unsigned int hw = std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_maxQueuedTasks > 0 && m_tasks.size() >= m_maxQueuedTasks) {
+            TRACE_SPAN("queue full"); // 生产者被处理速度限制的时间
+            m_spaceAvailable.wait(lock, [this] { return m_tasks.size() < m_maxQueuedTasks; });
+        }
+        m_tasks.push_back(std::move(task));
+    }
+    m_taskAvailable.notify_one();
+}
+
+void ThreadPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_tasks.empty() && m_activeTasks == 0; });
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    Trace::setThreadName("worker " + std::to_string(index));
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_taskAvailable.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+            if (m_tasks.empty()) {
+                return; // m_stopping 且没有剩余任务
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            ++m_activeTasks;
+        }
+        m_spaceAvailable.notify_one();
+
+        try {
+            task();
+        } catch (const std::exception& e) {
+            LOG_ERROR << "Error: Unhandled exception in worker task: " << e.what();
+        } catch (...) {
+            LOG_ERROR << "Error: Unknown exception in worker task.";
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_activeTasks;
+            if (m_tasks.empty() && m_activeTasks == 0) {
+                m_idle.notify_all();
+            }
+        }
+    }
+}
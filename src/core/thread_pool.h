@@ -0,0 +1,48 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 固定大小的工作线程池。
+// maxQueuedTasks > 0 时队列有上限：submit() 在队列已满时阻塞，
+// 让生产者（例如目录枚举）与处理速度保持同步，而不会无限堆积任务。
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threadCount, size_t maxQueuedTasks = 0);
+    ~ThreadPool(); // 等待所有已提交的任务完成后再退出
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    // 阻塞直到队列为空且没有正在执行的任务
+    void waitIdle();
+
+    size_t getThreadCount() const { return m_workers.size(); }
+
+    // threadCount 为 0 时使用的默认线程数（硬件并发数，至少为 1）
+    static size_t defaultThreadCount();
+
+private:
+    void workerLoop(size_t index);
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_tasks;
+    size_t m_maxQueuedTasks;
+    size_t m_activeTasks = 0;
+    bool m_stopping = false;
+
+    std::mutex m_mutex;
+    std::condition_variable m_taskAvailable;
+    std::condition_variable m_spaceAvailable;
+    std::condition_variable m_idle;
+};
+
+#endif // THREAD_POOL_H
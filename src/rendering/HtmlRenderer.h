@@ -2,16 +2,23 @@
 #define HTML_RENDERER_H
 
 #include "IRenderer.h"
+#include <ostream>
 
 class HtmlRenderer : public IRenderer {
 public:
     bool render(
         const std::vector<std::vector<CharColorInfo>>& asciiData,
-        const std::filesystem::path& outputPath,
+        OutputSink& sink,
         const Config& config,
         ColorScheme scheme) const override;
 
     std::string getOutputFileExtension() const override;
+
+private:
+    void writeDocument(std::ostream& out,
+        const std::vector<std::vector<CharColorInfo>>& asciiData,
+        const Config& config,
+        ColorScheme scheme) const;
 };
 
 #endif // HTML_RENDERER_H
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define IRENDERER_H
 
 #include "common_types.h"
+#include "OutputSink.h"
 #include <filesystem>
 #include <string>
 #include <vector>
@@ -10,15 +11,30 @@ class IRenderer {
 public:
     virtual ~IRenderer() = default;
 
-    // 纯虚函数，用于执行渲染操作
+    // 纯虚函数，用于执行渲染操作：按块写入 sink，不负责调用 sink.finish()
     virtual bool render(
         const std::vector<std::vector<CharColorInfo>>& asciiData,
-        const std::filesystem::path& outputPath,
+        OutputSink& sink,
         const Config& config,
         ColorScheme scheme) const = 0;
 
+    // 便捷封装：渲染到文件
+    bool renderToFile(
+        const std::vector<std::vector<CharColorInfo>>& asciiData,
+        const std::filesystem::path& outputPath,
+        const Config& config,
+        ColorScheme scheme) const
+    {
+        FileSink sink(outputPath);
+        if (!sink.isOpen()) {
+            return false;
+        }
+        const bool rendered = render(asciiData, sink, config, scheme);
+        return sink.finish() && rendered;
+    }
+
     // 纯虚函数，用于获取该渲染器对应的文件扩展名
     virtual std::string getOutputFileExtension() const = 0;
 };
 
-#endif // IRENDERER_H
\ No newline at end of file
+#endif // IRENDERER_H
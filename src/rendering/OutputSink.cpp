@@ -0,0 +1,121 @@
+#include "OutputSink.h"
+#include "utils/Logger.h"
+#include <cerrno>
+#include <cstring>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// --- FileSink ---
+
+FileSink::FileSink(const std::filesystem::path& filePath) : m_path(filePath) {
+#if defined(_WIN32) || defined(_WIN64)
+    m_file = _wfopen(filePath.wstring().c_str(), L"wb");
+#else
+    m_file = std::fopen(filePath.string().c_str(), "wb");
+#endif
+    if (!m_file) {
+        LOG_ERROR << "Error: Failed to open file for writing: " << m_path.string();
+        m_failed = true;
+    }
+}
+
+FileSink::~FileSink() {
+    if (m_file) {
+        std::fclose(m_file);
+    }
+}
+
+bool FileSink::write(const void* data, size_t size) {
+    if (m_failed) return false;
+    if (size > 0 && std::fwrite(data, 1, size, m_file) != size) {
+        LOG_ERROR << "Error: Failed to write to " << m_path.string();
+        m_failed = true;
+    }
+    return !m_failed;
+}
+
+bool FileSink::finish() {
+    if (!m_file) return false;
+    std::FILE* file = m_file;
+    m_file = nullptr;
+    if (std::fclose(file) != 0 && !m_failed) {
+        LOG_ERROR << "Error: Failed to write all data or close the file: " << m_path.string();
+        m_failed = true;
+    }
+    return !m_failed;
+}
+
+// --- MemorySink ---
+
+bool MemorySink::write(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    m_target.insert(m_target.end(), bytes, bytes + size);
+    return true;
+}
+
+// --- FdSink ---
+
+bool FdSink::write(const void* data, size_t size) {
+    if (m_failed) return false;
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+#if defined(_WIN32) || defined(_WIN64)
+        const unsigned int chunk = size > (1u << 30) ? (1u << 30) : static_cast<unsigned int>(size);
+        const int written = _write(m_fd, bytes, chunk);
+#else
+        const ssize_t written = ::write(m_fd, bytes, size);
+#endif
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR << "Error: Failed to write to " << m_name << ": " << std::strerror(errno);
+            m_failed = true;
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// --- SinkStreamBuf ---
+
+SinkStreamBuf::SinkStreamBuf(OutputSink& sink) : m_sink(sink), m_buffer(CHUNK_SIZE) {
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+}
+
+SinkStreamBuf::~SinkStreamBuf() {
+    flushBuffer();
+}
+
+bool SinkStreamBuf::flushBuffer() {
+    const std::ptrdiff_t pending = pptr() - pbase();
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+    if (pending <= 0) return !m_sink.failed();
+    return m_sink.write(m_buffer.data(), static_cast<size_t>(pending));
+}
+
+SinkStreamBuf::int_type SinkStreamBuf::overflow(int_type ch) {
+    if (!flushBuffer()) return traits_type::eof();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize SinkStreamBuf::xsputn(const char* s, std::streamsize count) {
+    // 大块数据直接交给 sink，避免先拷进缓冲区
+    if (count >= static_cast<std::streamsize>(m_buffer.size())) {
+        if (!flushBuffer() || !m_sink.write(s, static_cast<size_t>(count))) return 0;
+        return count;
+    }
+    return std::streambuf::xsputn(s, count);
+}
+
+int SinkStreamBuf::sync() {
+    return flushBuffer() ? 0 : -1;
+}
@@ -0,0 +1,97 @@
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 渲染器的输出目标。渲染器按块调用 write()，全部写完后由调用方调用 finish()。
+// 任何一次写入失败后 sink 进入失败状态，之后的 write()/finish() 都返回 false。
+class OutputSink {
+public:
+    virtual ~OutputSink() = default;
+
+    virtual bool write(const void* data, size_t size) = 0;
+    // 刷新并关闭底层目标；默认没有需要收尾的内容
+    virtual bool finish() { return !m_failed; }
+    // 用于错误信息，例如文件路径或 "memory buffer"
+    virtual std::string describe() const = 0;
+
+    bool failed() const { return m_failed; }
+
+protected:
+    bool m_failed = false;
+};
+
+// 写入文件（以二进制方式打开，已存在则截断）
+class FileSink : public OutputSink {
+public:
+    explicit FileSink(const std::filesystem::path& filePath);
+    ~FileSink() override;
+
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+
+    bool isOpen() const { return m_file != nullptr; }
+    bool write(const void* data, size_t size) override;
+    bool finish() override;
+    std::string describe() const override { return m_path.string(); }
+
+private:
+    std::filesystem::path m_path;
+    std::FILE* m_file = nullptr;
+};
+
+// 追加到调用方持有的缓冲区，不做额外拷贝
+class MemorySink : public OutputSink {
+public:
+    explicit MemorySink(std::vector<unsigned char>& target) : m_target(target) {}
+
+    bool write(const void* data, size_t size) override;
+    std::string describe() const override { return "memory buffer"; }
+
+private:
+    std::vector<unsigned char>& m_target;
+};
+
+// 写入已打开的文件描述符（标准输出、管道、套接字）；不负责关闭它
+class FdSink : public OutputSink {
+public:
+    FdSink(int fd, std::string name) : m_fd(fd), m_name(std::move(name)) {}
+
+    bool write(const void* data, size_t size) override;
+    std::string describe() const override { return m_name; }
+
+private:
+    int m_fd;
+    std::string m_name;
+};
+
+// 把 std::ostream 的输出按固定大小的块转交给 sink，供逐段生成文本的渲染器使用
+class SinkStreamBuf : public std::streambuf {
+public:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    explicit SinkStreamBuf(OutputSink& sink);
+    ~SinkStreamBuf() override;
+
+    SinkStreamBuf(const SinkStreamBuf&) = delete;
+    SinkStreamBuf& operator=(const SinkStreamBuf&) = delete;
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* s, std::streamsize count) override;
+    int sync() override;
+
+private:
+    bool flushBuffer();
+
+    OutputSink& m_sink;
+    std::vector<char> m_buffer;
+};
+
+#endif // OUTPUT_SINK_H
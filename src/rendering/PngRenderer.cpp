@@ -1,8 +1,14 @@
 #include "PngRenderer.h"
-#include <iostream>
+#include "RenderUtils.h"
+#include "utils/MappedFile.h"
+#include "utils/Logger.h"
+#include "utils/Trace.h"
+#include "utils/PerfCounters.h"
 #include <vector>
 #include <cmath>
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <stdexcept>
 
 // --- STB IMPLEMENTATION ---
@@ -13,68 +19,52 @@
 
 namespace { // Anonymous namespace for internal helpers
 
-// --- Font Loading Helper ---
-struct FontInfo {
-    stbtt_fontinfo info;
-    std::vector<unsigned char> buffer;
-    bool loaded = false;
-};
-
-FontInfo loadFont(const std::string& fontPath) {
-    FontInfo font;
-    std::cout << "Loading font file: " << fontPath << " ..." << std::endl;
-    font.buffer = readFileBytes(fontPath);
-    if (font.buffer.empty()) {
-        std::cerr << "Error: Font file buffer is empty or could not be read: " << fontPath << std::endl;
-        return font;
-    }
-    if (!stbtt_InitFont(&font.info, font.buffer.data(), stbtt_GetFontOffsetForIndex(font.buffer.data(), 0))) {
-        std::cerr << "Error: Failed to initialize font: " << fontPath << std::endl;
-        return font;
-    }
-    std::cout << "Font loaded successfully: " << fontPath << std::endl;
-    font.loaded = true;
-    return font;
-}
-
-// --- Rendering Helpers ---
-
 struct RenderMetrics {
     int charWidthPx = 0;
     int lineHeightPx = 0;
     int outputImageWidthPx = 0;
     int outputImageHeightPx = 0;
-    float scale = 0.0f;
     int ascentPx = 0;
     bool valid = false;
 };
 
-RenderMetrics calculateOutputDimensions(const stbtt_fontinfo& fontInfo, float fontSize, int asciiWidth, int asciiHeight) {
+} // end anonymous namespace
+
+// 预先栅格化的字形
+struct PngRenderer::GlyphBitmap {
+    int width = 0;
+    int height = 0;
+    int xoff = 0;
+    int yoff = 0;
+    std::vector<unsigned char> alpha;
+};
+
+// 一种字体 + 字号的字形图集：字体文件只映射一次，可打印 ASCII 字符在创建时全部栅格化，
+// 之后每个字符单元只需一次位图拷贝混合，不再调用 stbtt_GetCodepointBitmap。
+struct PngRenderer::GlyphAtlas {
+    MappedFile fontFile; // stbtt_fontinfo 直接引用映射的内容，不另行复制
+    stbtt_fontinfo info;
+    float scale = 0.0f;
+    int ascentPx = 0;
+    int lineHeightPx = 0;
+    int charWidthPx = 0;
+    std::array<GlyphBitmap, 128> glyphs;
+};
+
+namespace {
+
+// --- Rendering Helpers ---
+
+RenderMetrics calculateOutputDimensions(const PngRenderer::GlyphAtlas& atlas, int asciiWidth, int asciiHeight) {
     RenderMetrics metrics;
     if (asciiWidth <= 0 || asciiHeight <= 0) {
-         std::cerr << "Error: Invalid ASCII dimensions (" << asciiWidth << "x" << asciiHeight << ") for rendering." << std::endl;
+         LOG_ERROR << "Error: Invalid ASCII dimensions (" << asciiWidth << "x" << asciiHeight << ") for rendering.";
          return metrics;
     }
 
-    metrics.scale = stbtt_ScaleForPixelHeight(&fontInfo, fontSize);
-    if (metrics.scale <= 0) {
-        std::cerr << "Error: Calculated font scale is invalid for font size " << fontSize << std::endl;
-        return metrics;
-    }
-
-    int ascent, descent, lineGap;
-    stbtt_GetFontVMetrics(&fontInfo, &ascent, &descent, &lineGap);
-    metrics.ascentPx = static_cast<int>(std::round(ascent * metrics.scale));
-    int descentPx = static_cast<int>(std::round(descent * metrics.scale));
-    int lineGapPx = static_cast<int>(std::round(lineGap * metrics.scale));
-
-    metrics.lineHeightPx = metrics.ascentPx - descentPx + lineGapPx;
-    metrics.lineHeightPx = std::max(1, metrics.lineHeightPx);
-
-    int advanceWidth, leftSideBearing;
-    stbtt_GetCodepointHMetrics(&fontInfo, 'M', &advanceWidth, &leftSideBearing);
-    metrics.charWidthPx = static_cast<int>(std::round(advanceWidth * metrics.scale));
-    metrics.charWidthPx = std::max(1, metrics.charWidthPx);
+    metrics.ascentPx = atlas.ascentPx;
+    metrics.lineHeightPx = atlas.lineHeightPx;
+    metrics.charWidthPx = atlas.charWidthPx;
 
     metrics.outputImageWidthPx = asciiWidth * metrics.charWidthPx;
     metrics.outputImageHeightPx = asciiHeight * metrics.lineHeightPx;
@@ -86,67 +76,23 @@ RenderMetrics calculateOutputDimensions(const stbtt_fontinfo& fontInfo, float fo
     return metrics;
 }
 
-void setSchemeColors(ColorScheme scheme, unsigned char bgColor[3], unsigned char fgColor[3]) {
-      switch (scheme) {
-        case ColorScheme::AMBER_ON_BLACK:
-            bgColor[0] = 0x00; bgColor[1] = 0x00; bgColor[2] = 0x00; fgColor[0] = 0xFF; fgColor[1] = 0xBF; fgColor[2] = 0x00; break;
-        case ColorScheme::BLACK_ON_YELLOW:
-            bgColor[0] = 0xFF; bgColor[1] = 0xFF; bgColor[2] = 0xAA; fgColor[0] = 0x00; fgColor[1] = 0x00; fgColor[2] = 0x00; break;
-        case ColorScheme::BLACK_ON_CYAN:
-            bgColor[0] = 0xAA; bgColor[1] = 0xFF; bgColor[2] = 0xFF; fgColor[0] = 0x00; fgColor[1] = 0x00; fgColor[2] = 0x00; break;
-        case ColorScheme::COLOR_ON_WHITE:
-            bgColor[0] = 0xC8; bgColor[1] = 0xC8; bgColor[2] = 0xC8; fgColor[0] = 0; fgColor[1] = 0; fgColor[2] = 0; break; // FG is per-char
-        case ColorScheme::COLOR_ON_BLACK:
-            bgColor[0] = 0x36; bgColor[1] = 0x36; bgColor[2] = 0x36; fgColor[0] = 0; fgColor[1] = 0; fgColor[2] = 0; break; // FG is per-char
-        case ColorScheme::CYAN_ON_BLACK:
-            bgColor[0] = 0x00; bgColor[1] = 0x00; bgColor[2] = 0x00; fgColor[0] = 0x00; fgColor[1] = 0xFF; fgColor[2] = 0xFF; break;
-        case ColorScheme::GRAY_ON_BLACK:
-             bgColor[0] = 0x00; bgColor[1] = 0x00; bgColor[2] = 0x00; fgColor[0] = 0xAA; fgColor[1] = 0xAA; fgColor[2] = 0xAA; break;
-        case ColorScheme::GREEN_ON_BLACK:
-            bgColor[0] = 0x00; bgColor[1] = 0x00; bgColor[2] = 0x00; fgColor[0] = 0x00; fgColor[1] = 0xFF; fgColor[2] = 0x00; break;
-        case ColorScheme::MAGENTA_ON_BLACK:
-            bgColor[0] = 0x00; bgColor[1] = 0x00; bgColor[2] = 0x00; fgColor[0] = 0xFF; fgColor[1] = 0x00; fgColor[2] = 0xFF; break;
-        case ColorScheme::PURPLE_ON_BLACK:
-            bgColor[0] = 0x00; bgColor[1] = 0x00; bgColor[2] = 0x00; fgColor[0] = 0x80; fgColor[1] = 0x00; fgColor[2] = 0x80; break;
-        case ColorScheme::SEPIA:
-            bgColor[0] = 0xF0; bgColor[1] = 0xE6; bgColor[2] = 0x8C; fgColor[0] = 0x70; fgColor[1] = 0x42; fgColor[2] = 0x14; break;
-        case ColorScheme::SOLARIZED_DARK:
-            bgColor[0] = 0x00; bgColor[1] = 0x2b; bgColor[2] = 0x36; fgColor[0] = 0x83; fgColor[1] = 0x94; fgColor[2] = 0x96; break;
-        case ColorScheme::SOLARIZED_LIGHT:
-            bgColor[0] = 0xfd; bgColor[1] = 0xf6; bgColor[2] = 0xe3; fgColor[0] = 0x65; fgColor[1] = 0x7b; fgColor[2] = 0x83; break;
-        case ColorScheme::WHITE_ON_BLACK:
-            bgColor[0] = 0x00; bgColor[1] = 0x00; bgColor[2] = 0x00; fgColor[0] = 0xFF; fgColor[1] = 0xFF; fgColor[2] = 0xFF; break;
-        case ColorScheme::WHITE_ON_BLUE:
-            bgColor[0] = 0x00; bgColor[1] = 0x00; bgColor[2] = 0xAA; fgColor[0] = 0xFF; fgColor[1] = 0xFF; fgColor[2] = 0xFF; break;
-        case ColorScheme::WHITE_ON_DARK_RED:
-            bgColor[0] = 0x8B; bgColor[1] = 0x00; bgColor[2] = 0x00; fgColor[0] = 0xFF; fgColor[1] = 0xFF; fgColor[2] = 0xFF; break;
-        case ColorScheme::YELLOW_ON_BLACK:
-             bgColor[0] = 0x00; bgColor[1] = 0x00; bgColor[2] = 0x00; fgColor[0] = 0xFF; fgColor[1] = 0xFF; fgColor[2] = 0x00; break;
-        case ColorScheme::BLACK_ON_WHITE:
-        default:
-            bgColor[0] = 0xC8; bgColor[1] = 0xC8; bgColor[2] = 0xC8; fgColor[0] = 0x00; fgColor[1] = 0x00; fgColor[2] = 0x00; break;
-    }
-}
-
-void renderGlyph(std::vector<unsigned char>& outputImageData,
-                 const stbtt_fontinfo& fontInfo, float scale, char c,
+void renderGlyph(unsigned char* outputImageData,
+                 const PngRenderer::GlyphBitmap& glyph,
                  int drawX_base, int drawY_base,
                  int imgWidth, int imgHeight,
                  const unsigned char finalColor[3],
                  const unsigned char bgColor[3])
 {
-    int char_w, char_h, xoff, yoff;
-    unsigned char* bitmap = stbtt_GetCodepointBitmap(&fontInfo, scale, scale, c, &char_w, &char_h, &xoff, &yoff);
+    if (glyph.alpha.empty()) return;
 
-    if (!bitmap) return;
+    for (int y = 0; y < glyph.height; ++y) {
+        int outY = drawY_base + glyph.yoff + y;
+        if (outY < 0 || outY >= imgHeight) continue;
+        for (int x = 0; x < glyph.width; ++x) {
+            int outX = drawX_base + glyph.xoff + x;
 
-    for (int y = 0; y < char_h; ++y) {
-        for (int x = 0; x < char_w; ++x) {
-            int outX = drawX_base + xoff + x;
-            int outY = drawY_base + yoff + y;
-
-            if (outX >= 0 && outX < imgWidth && outY >= 0 && outY < imgHeight) {
-                unsigned char alpha = bitmap[y * char_w + x];
+            if (outX >= 0 && outX < imgWidth) {
+                unsigned char alpha = glyph.alpha[static_cast<size_t>(y) * glyph.width + x];
                 if (alpha > 10) {
                     size_t pixelIndex = (static_cast<size_t>(outY) * imgWidth + outX) * OUTPUT_CHANNELS;
                     float alphaF = alpha / 255.0f;
@@ -158,80 +104,196 @@ void renderGlyph(std::vector<unsigned char>& outputImageData,
             }
         }
     }
-    stbtt_FreeBitmap(bitmap, nullptr);
 }
 
 
-bool saveImagePng(const std::filesystem::path& outputPath, int width, int height, int channels, const std::vector<unsigned char>& data) {
-    if (width <= 0 || height <= 0) {
-        std::cerr << "Error: Invalid dimensions (" << width << "x" << height << ") for saveImage." << std::endl;
-        return false;
+// stb 的编码器通过回调交出编码结果，直接转交给 sink
+void writeToSink(void* context, void* data, int size) {
+    auto* sink = static_cast<OutputSink*>(context);
+    if (size > 0) {
+        sink->write(data, static_cast<size_t>(size));
     }
-    size_t expectedSize = static_cast<size_t>(width) * height * channels;
-     if (data.size() != expectedSize) {
-         std::cerr << "Error: Data size (" << data.size() << ") != expected (" << expectedSize << ") for saveImage." << std::endl;
-         return false;
-     }
+}
 
-    if (!stbi_write_png(outputPath.string().c_str(), width, height, channels, data.data(), width * channels)) {
-        std::cerr << "Error: Failed to save PNG image to '" << outputPath.string() << "'" << std::endl;
-        return false;
+} // end anonymous namespace
+
+namespace {
+
+std::shared_ptr<const PngRenderer::GlyphAtlas> buildGlyphAtlas(const std::string& fontPath, float fontSize) {
+    TRACE_SPAN("font atlas");
+    auto atlas = std::make_shared<PngRenderer::GlyphAtlas>();
+    LOG_INFO << "Loading font file: " << fontPath << " ...";
+    if (!atlas->fontFile.open(fontPath, MappedFile::Access::WillNeed) || atlas->fontFile.size() == 0) {
+        LOG_ERROR << "Error: Font file buffer is empty or could not be read: " << fontPath;
+        return nullptr;
     }
-    return true;
+    if (!stbtt_InitFont(&atlas->info, atlas->fontFile.data(), stbtt_GetFontOffsetForIndex(atlas->fontFile.data(), 0))) {
+        LOG_ERROR << "Error: Failed to initialize font: " << fontPath;
+        return nullptr;
+    }
+
+    atlas->scale = stbtt_ScaleForPixelHeight(&atlas->info, fontSize);
+    if (atlas->scale <= 0) {
+        LOG_ERROR << "Error: Calculated font scale is invalid for font size " << fontSize;
+        return nullptr;
+    }
+
+    int ascent, descent, lineGap;
+    stbtt_GetFontVMetrics(&atlas->info, &ascent, &descent, &lineGap);
+    atlas->ascentPx = static_cast<int>(std::round(ascent * atlas->scale));
+    int descentPx = static_cast<int>(std::round(descent * atlas->scale));
+    int lineGapPx = static_cast<int>(std::round(lineGap * atlas->scale));
+    atlas->lineHeightPx = std::max(1, atlas->ascentPx - descentPx + lineGapPx);
+
+    int advanceWidth, leftSideBearing;
+    stbtt_GetCodepointHMetrics(&atlas->info, 'M', &advanceWidth, &leftSideBearing);
+    atlas->charWidthPx = std::max(1, static_cast<int>(std::round(advanceWidth * atlas->scale)));
+
+    for (int c = 32; c < 127; ++c) {
+        PngRenderer::GlyphBitmap& glyph = atlas->glyphs[c];
+        unsigned char* bitmap = stbtt_GetCodepointBitmap(&atlas->info, atlas->scale, atlas->scale, c,
+                                                         &glyph.width, &glyph.height, &glyph.xoff, &glyph.yoff);
+        if (bitmap) {
+            glyph.alpha.assign(bitmap, bitmap + static_cast<size_t>(glyph.width) * glyph.height);
+            stbtt_FreeBitmap(bitmap, nullptr);
+        }
+    }
+    LOG_INFO << "Font loaded successfully: " << fontPath << " (" << fontSize << "px glyph atlas)";
+
+    return atlas;
 }
 
 } // end anonymous namespace
 
+std::shared_ptr<const PngRenderer::GlyphAtlas> PngRenderer::getGlyphAtlas(const std::string& fontPath, float fontSize) const {
+    const std::string key = fontPath + "@" + std::to_string(fontSize);
+    std::promise<std::shared_ptr<const GlyphAtlas>> promise;
+    std::shared_future<std::shared_ptr<const GlyphAtlas>> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_atlasMutex);
+        auto it = m_atlasCache.find(key);
+        if (it != m_atlasCache.end()) {
+            it->second.lastUse = ++m_atlasUseCounter;
+            pending = it->second.atlas;
+        } else {
+            // 淘汰只移除缓存中的引用：正在使用旧图集的渲染持有自己的 shared_ptr
+            if (m_atlasCache.size() >= ATLAS_CACHE_CAPACITY) {
+                auto oldest = std::min_element(m_atlasCache.begin(), m_atlasCache.end(),
+                    [](const auto& a, const auto& b) { return a.second.lastUse < b.second.lastUse; });
+                m_atlasCache.erase(oldest);
+            }
+            AtlasCacheEntry& entry = m_atlasCache[key];
+            entry.atlas = promise.get_future().share();
+            entry.lastUse = ++m_atlasUseCounter;
+        }
+    }
+    if (pending.valid()) {
+        return pending.get();
+    }
+
+    std::shared_ptr<const GlyphAtlas> atlas;
+    try {
+        atlas = buildGlyphAtlas(fontPath, fontSize);
+    } catch (const std::bad_alloc&) {
+        LOG_ERROR << "Error: Out of memory building the " << fontSize << "px glyph atlas for " << fontPath;
+    }
+    promise.set_value(atlas);
+    if (!atlas) {
+        // 失败不缓存，之后的请求重新尝试（例如字体文件稍后才出现）；
+        // 期间同一键可能已被淘汰后重新创建，只移除已完成且失败的条目
+        std::lock_guard<std::mutex> lock(m_atlasMutex);
+        auto it = m_atlasCache.find(key);
+        if (it != m_atlasCache.end() && it->second.atlas.wait_for(std::chrono::seconds(0)) == std::future_status::ready &&
+            !it->second.atlas.get()) {
+            m_atlasCache.erase(it);
+        }
+    }
+    return atlas;
+}
+
 bool PngRenderer::render(
     const std::vector<std::vector<CharColorInfo>>& asciiData,
-    const std::filesystem::path& outputPath,
+    OutputSink& sink,
     const Config& config,
     ColorScheme scheme) const
+{
+    // 画布来自线程本地的缓冲池：同一工作线程渲染下一张相近尺寸的图片时复用已触碰过的页
+    BufferPool::Buffer outputImageData;
+    int imageWidth = 0;
+    int imageHeight = 0;
+    {
+        TRACE_SPAN("rasterize");
+        PERF_SCOPE("rasterize");
+        if (!rasterize(asciiData, config, scheme, outputImageData, imageWidth, imageHeight)) {
+            return false;
+        }
+    }
+
+    TRACE_SPAN("encode png");
+    PERF_SCOPE("encode png");
+    if (!stbi_write_png_to_func(writeToSink, &sink, imageWidth, imageHeight, OUTPUT_CHANNELS,
+                                outputImageData.data(), imageWidth * OUTPUT_CHANNELS)
+        || sink.failed()) {
+        LOG_ERROR << "Error: Failed to save PNG image to '" << sink.describe() << "'";
+        return false;
+    }
+    return true;
+}
+
+bool PngRenderer::rasterize(
+    const std::vector<std::vector<CharColorInfo>>& asciiData,
+    const Config& config,
+    ColorScheme scheme,
+    BufferPool::Buffer& outputImageData,
+    int& imageWidth,
+    int& imageHeight) const
 {
     if (asciiData.empty() || asciiData[0].empty()) {
-        std::cerr << "Error: Cannot render empty ASCII data to PNG." << std::endl;
+        LOG_ERROR << "Error: Cannot render empty ASCII data to PNG.";
         return false;
     }
 
-    FontInfo font = loadFont(config.finalFontPath);
-    if (!font.loaded) {
+    std::shared_ptr<const GlyphAtlas> atlas = getGlyphAtlas(config.finalFontPath, config.fontSize);
+    if (!atlas) {
         return false;
     }
 
     int asciiHeight = static_cast<int>(asciiData.size());
     int asciiWidth = static_cast<int>(asciiData[0].size());
-    RenderMetrics metrics = calculateOutputDimensions(font.info, config.fontSize, asciiWidth, asciiHeight);
+    RenderMetrics metrics = calculateOutputDimensions(*atlas, asciiWidth, asciiHeight);
 
     if (!metrics.valid) {
-        std::cerr << "Error: Could not calculate valid output dimensions for PNG." << std::endl;
+        LOG_ERROR << "Error: Could not calculate valid output dimensions for PNG.";
         return false;
     }
-     std::cout << "Calculated PNG output: " << metrics.outputImageWidthPx << "x" << metrics.outputImageHeightPx << std::endl;
+     LOG_DEBUG << "Calculated PNG output: " << metrics.outputImageWidthPx << "x" << metrics.outputImageHeightPx;
 
     unsigned char bgColor[3], baseFgColor[3];
-    setSchemeColors(scheme, bgColor, baseFgColor);
-    bool usePixelColor = (scheme == ColorScheme::COLOR_ON_WHITE || scheme == ColorScheme::COLOR_ON_BLACK);
+    RenderUtils::setSchemeColors(scheme, bgColor, baseFgColor);
+    bool usePixelColor = RenderUtils::usesPixelColor(scheme);
 
-    std::vector<unsigned char> outputImageData;
     try {
         size_t required_size = static_cast<size_t>(metrics.outputImageWidthPx) * metrics.outputImageHeightPx * OUTPUT_CHANNELS;
         if (metrics.outputImageWidthPx <= 0 || metrics.outputImageHeightPx <= 0 || required_size == 0 ||
             static_cast<double>(metrics.outputImageWidthPx) * metrics.outputImageHeightPx > (10000.0 * 10000.0) ) {
                  throw std::runtime_error("Calculated PNG dimensions are invalid or excessively large.");
         }
-        outputImageData.resize(required_size);
+        if (!outputImageData.resize(required_size)) {
+            throw std::bad_alloc();
+        }
     } catch (const std::bad_alloc& e) {
-        std::cerr << "Error: Failed to allocate memory for PNG buffer (" << metrics.outputImageWidthPx << "x" << metrics.outputImageHeightPx << "): " << e.what() << std::endl;
+        LOG_ERROR << "Error: Failed to allocate memory for PNG buffer (" << metrics.outputImageWidthPx << "x" << metrics.outputImageHeightPx << "): " << e.what();
         return false;
     } catch (const std::exception& e) {
-         std::cerr << "Error: Allocating PNG buffer: " << e.what() << std::endl;
+         LOG_ERROR << "Error: Allocating PNG buffer: " << e.what();
          return false;
     }
 
+    unsigned char* pixels = outputImageData.data();
     for (size_t i = 0; i < outputImageData.size(); i += OUTPUT_CHANNELS) {
-        outputImageData[i]     = bgColor[0];
-        outputImageData[i + 1] = bgColor[1];
-        outputImageData[i + 2] = bgColor[2];
+        pixels[i]     = bgColor[0];
+        pixels[i + 1] = bgColor[1];
+        pixels[i + 2] = bgColor[2];
     }
 
     int currentY_baseline = metrics.ascentPx;
@@ -239,22 +301,21 @@ bool PngRenderer::render(
     for (const auto& lineData : asciiData) {
         int currentX = 0;
         for (const auto& charInfo : lineData) {
-            char c = charInfo.character;
+            unsigned char c = static_cast<unsigned char>(charInfo.character);
             const unsigned char* renderColor = usePixelColor ? charInfo.color : baseFgColor;
-            renderGlyph(outputImageData, font.info, metrics.scale, c,
-                        currentX, currentY_baseline,
-                        metrics.outputImageWidthPx, metrics.outputImageHeightPx,
-                        renderColor, bgColor);
+            if (c < atlas->glyphs.size()) {
+                renderGlyph(pixels, atlas->glyphs[c],
+                            currentX, currentY_baseline,
+                            metrics.outputImageWidthPx, metrics.outputImageHeightPx,
+                            renderColor, bgColor);
+            }
             currentX += metrics.charWidthPx;
         }
         currentY_baseline += metrics.lineHeightPx;
     }
 
-    std::cout << "Saving PNG: " << outputPath.filename().string() << std::endl;
-    if (!saveImagePng(outputPath, metrics.outputImageWidthPx, metrics.outputImageHeightPx, OUTPUT_CHANNELS, outputImageData)) {
-        return false;
-    }
-
+    imageWidth = metrics.outputImageWidthPx;
+    imageHeight = metrics.outputImageHeightPx;
     return true;
 }
 
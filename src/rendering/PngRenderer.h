@@ -2,16 +2,51 @@
 #define PNG_RENDERER_H
 
 #include "IRenderer.h"
+#include "utils/BufferPool.h"
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
 
 class PngRenderer : public IRenderer {
 public:
     bool render(
         const std::vector<std::vector<CharColorInfo>>& asciiData,
-        const std::filesystem::path& outputPath,
+        OutputSink& sink,
         const Config& config,
         ColorScheme scheme) const override;
 
     std::string getOutputFileExtension() const override;
+
+    struct GlyphBitmap;
+    struct GlyphAtlas;
+
+    // 同时缓存的 字体@字号 图集数量；超出时淘汰最久未使用的一个（常驻服务中字号由请求决定）
+    static constexpr size_t ATLAS_CACHE_CAPACITY = 8;
+
+private:
+    // 把 ASCII 网格绘制为 RGB 像素，随后由 render() 编码并写入 sink
+    bool rasterize(
+        const std::vector<std::vector<CharColorInfo>>& asciiData,
+        const Config& config,
+        ColorScheme scheme,
+        BufferPool::Buffer& outputImageData,
+        int& imageWidth,
+        int& imageHeight) const;
+
+    // 按字体路径和字号缓存字形图集；渲染器在多个工作线程间共享，因此加锁。
+    // 锁只保护缓存表：图集在锁外栅格化，同一键的并发请求等待同一个 future，其他字号的渲染不受影响
+    std::shared_ptr<const GlyphAtlas> getGlyphAtlas(const std::string& fontPath, float fontSize) const;
+
+    struct AtlasCacheEntry {
+        std::shared_future<std::shared_ptr<const GlyphAtlas>> atlas; // 创建失败时为 nullptr
+        uint64_t lastUse = 0;
+    };
+
+    mutable std::mutex m_atlasMutex;
+    mutable std::map<std::string, AtlasCacheEntry> m_atlasCache;
+    mutable uint64_t m_atlasUseCounter = 0;
 };
 
 #endif // PNG_RENDERER_H
\ No newline at end of file
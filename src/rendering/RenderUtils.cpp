@@ -0,0 +1,71 @@
+#include "RenderUtils.h"
+#include <iomanip>
+#include <sstream>
+
+namespace RenderUtils {
+
+void setSchemeColors(ColorScheme scheme, unsigned char bgColor[3], unsigned char fgColor[3]) {
+      switch (scheme) {
+        case ColorScheme::AMBER_ON_BLACK:
+            bgColor[0] = 0x00; bgColor[1] = 0x00; bgColor[2] = 0x00; fgColor[0] = 0xFF; fgColor[1] = 0xBF; fgColor[2] = 0x00; break;
+        case ColorScheme::BLACK_ON_YELLOW:
+            bgColor[0] = 0xFF; bgColor[1] = 0xFF; bgColor[2] = 0xAA; fgColor[0] = 0x00; fgColor[1] = 0x00; fgColor[2] = 0x00; break;
+        case ColorScheme::BLACK_ON_CYAN:
+            bgColor[0] = 0xAA; bgColor[1] = 0xFF; bgColor[2] = 0xFF; fgColor[0] = 0x00; fgColor[1] = 0x00; fgColor[2] = 0x00; break;
+        case ColorScheme::COLOR_ON_WHITE:
+            bgColor[0] = 0xC8; bgColor[1] = 0xC8; bgColor[2] = 0xC8; fgColor[0] = 0; fgColor[1] = 0; fgColor[2] = 0; break; // FG is per-char
+        case ColorScheme::COLOR_ON_BLACK:
+            bgColor[0] = 0x36; bgColor[1] = 0x36; bgColor[2] = 0x36; fgColor[0] = 0; fgColor[1] = 0; fgColor[2] = 0; break; // FG is per-char
+        case ColorScheme::CYAN_ON_BLACK:
+            bgColor[0] = 0x00; bgColor[1] = 0x00; bgColor[2] = 0x00; fgColor[0] = 0x00; fgColor[1] = 0xFF; fgColor[2] = 0xFF; break;
+        case ColorScheme::GRAY_ON_BLACK:
+             bgColor[0] = 0x00; bgColor[1] = 0x00; bgColor[2] = 0x00; fgColor[0] = 0xAA; fgColor[1] = 0xAA; fgColor[2] = 0xAA; break;
+        case ColorScheme::GREEN_ON_BLACK:
+            bgColor[0] = 0x00; bgColor[1] = 0x00; bgColor[2] = 0x00; fgColor[0] = 0x00; fgColor[1] = 0xFF; fgColor[2] = 0x00; break;
+        case ColorScheme::MAGENTA_ON_BLACK:
+            bgColor[0] = 0x00; bgColor[1] = 0x00; bgColor[2] = 0x00; fgColor[0] = 0xFF; fgColor[1] = 0x00; fgColor[2] = 0xFF; break;
+        case ColorScheme::PURPLE_ON_BLACK:
+            bgColor[0] = 0x00; bgColor[1] = 0x00; bgColor[2] = 0x00; fgColor[0] = 0x80; fgColor[1] = 0x00; fgColor[2] = 0x80; break;
+        case ColorScheme::SEPIA:
+            bgColor[0] = 0xF0; bgColor[1] = 0xE6; bgColor[2] = 0x8C; fgColor[0] = 0x70; fgColor[1] = 0x42; fgColor[2] = 0x14; break;
+        case ColorScheme::SOLARIZED_DARK:
+            bgColor[0] = 0x00; bgColor[1] = 0x2b; bgColor[2] = 0x36; fgColor[0] = 0x83; fgColor[1] = 0x94; fgColor[2] = 0x96; break;
+        case ColorScheme::SOLARIZED_LIGHT:
+            bgColor[0] = 0xfd; bgColor[1] = 0xf6; bgColor[2] = 0xe3; fgColor[0] = 0x65; fgColor[1] = 0x7b; fgColor[2] = 0x83; break;
+        case ColorScheme::WHITE_ON_BLACK:
+            bgColor[0] = 0x00; bgColor[1] = 0x00; bgColor[2] = 0x00; fgColor[0] = 0xFF; fgColor[1] = 0xFF; fgColor[2] = 0xFF; break;
+        case ColorScheme::WHITE_ON_BLUE:
+            bgColor[0] = 0x00; bgColor[1] = 0x00; bgColor[2] = 0xAA; fgColor[0] = 0xFF; fgColor[1] = 0xFF; fgColor[2] = 0xFF; break;
+        case ColorScheme::WHITE_ON_DARK_RED:
+            bgColor[0] = 0x8B; bgColor[1] = 0x00; bgColor[2] = 0x00; fgColor[0] = 0xFF; fgColor[1] = 0xFF; fgColor[2] = 0xFF; break;
+        case ColorScheme::YELLOW_ON_BLACK:
+             bgColor[0] = 0x00; bgColor[1] = 0x00; bgColor[2] = 0x00; fgColor[0] = 0xFF; fgColor[1] = 0xFF; fgColor[2] = 0x00; break;
+        case ColorScheme::BLACK_ON_WHITE:
+        default:
+            bgColor[0] = 0xC8; bgColor[1] = 0xC8; bgColor[2] = 0xC8; fgColor[0] = 0x00; fgColor[1] = 0x00; fgColor[2] = 0x00; break;
+    }
+}
+
+bool usesPixelColor(ColorScheme scheme) {
+    return scheme == ColorScheme::COLOR_ON_WHITE || scheme == ColorScheme::COLOR_ON_BLACK;
+}
+
+std::string rgbToHex(const unsigned char color[3]) {
+    std::stringstream ss;
+    ss << "#";
+    for (int i = 0; i < 3; ++i) {
+        ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(color[i]);
+    }
+    return ss.str();
+}
+
+std::string getFontFamilyName(const Config& config) {
+    std::filesystem::path fontPathObj(config.fontFilename);
+    return fontPathObj.stem().string(); // Get "Consolas" from "Consolas.ttf"
+}
+
+std::string getFontFamilyList(const Config& config) {
+    return "\"" + getFontFamilyName(config) + "\", Consolas, Menlo, Monaco, 'Courier New', monospace";
+}
+
+} // namespace RenderUtils
@@ -0,0 +1,27 @@
+#ifndef RENDER_UTILS_H
+#define RENDER_UTILS_H
+
+#include "common_types.h"
+#include <string>
+
+// 各渲染器共享的辅助函数（颜色方案、颜色格式化、字体族名）。
+namespace RenderUtils {
+
+    // 根据颜色方案填充背景色和前景色
+    void setSchemeColors(ColorScheme scheme, unsigned char bgColor[3], unsigned char fgColor[3]);
+
+    // 该方案是否使用每个字符的原始像素颜色
+    bool usesPixelColor(ColorScheme scheme);
+
+    // 将 RGB 转换为 "#rrggbb" 形式的十六进制字符串
+    std::string rgbToHex(const unsigned char color[3]);
+
+    // 从 fontFilename 推导出 CSS/SVG 中使用的字体族名（例如 "Consolas.ttf" -> "Consolas"）
+    std::string getFontFamilyName(const Config& config);
+
+    // 完整的 font-family 列表，首选配置的字体，其后为常见等宽字体作为回退
+    std::string getFontFamilyList(const Config& config);
+
+} // namespace RenderUtils
+
+#endif // RENDER_UTILS_H
@@ -0,0 +1,141 @@
+#include "SvgRenderer.h"
+#include "RenderUtils.h"
+#include "utils/Logger.h"
+#include <iomanip>
+#include <cstdio>
+
+namespace { // Anonymous namespace for internal helpers
+
+// 等宽字体的字符宽度约为字号的 0.6 倍；每行通过 textLength 强制对齐到该网格，
+// 因此即使浏览器回退到其他等宽字体，列也不会错位。
+constexpr double SVG_CHAR_WIDTH_EM = 0.6;
+constexpr double SVG_BASELINE_EM = 0.8;
+
+// Helper to append an XML-escaped character
+void appendEscapedXmlChar(std::string& out, char c) {
+    switch (c) {
+        case '&': out += "&amp;"; break;
+        case '<': out += "&lt;"; break;
+        case '>': out += "&gt;"; break;
+        default:  out += c; break;
+    }
+}
+
+bool sameColor(const unsigned char a[3], const unsigned char b[3]) {
+    return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+}
+
+// Appends one row as <tspan> runs: consecutive characters with the same colour share a run.
+// Spaces are invisible, so they are merged into whatever run is currently open.
+void appendColoredRow(std::string& out, const std::vector<CharColorInfo>& lineData) {
+    size_t i = 0;
+    while (i < lineData.size()) {
+        // Leading spaces before the first visible character go out without a tspan
+        if (lineData[i].character == ' ') {
+            out += ' ';
+            ++i;
+            continue;
+        }
+        const unsigned char* runColor = lineData[i].color;
+        out += "<tspan fill=\"";
+        out += RenderUtils::rgbToHex(runColor);
+        out += "\">";
+        while (i < lineData.size() &&
+               (lineData[i].character == ' ' || sameColor(lineData[i].color, runColor))) {
+            appendEscapedXmlChar(out, lineData[i].character);
+            ++i;
+        }
+        out += "</tspan>";
+    }
+}
+
+} // end anonymous namespace
+
+bool SvgRenderer::render(
+    const std::vector<std::vector<CharColorInfo>>& asciiData,
+    OutputSink& sink,
+    const Config& config,
+    ColorScheme scheme) const
+{
+    if (asciiData.empty() || asciiData[0].empty()) {
+        LOG_ERROR << "Error: Cannot render empty ASCII data to SVG.";
+        return false;
+    }
+
+    // 文档逐段生成，经 64 KiB 的缓冲按块写入 sink，不在内存中拼出完整文件
+    SinkStreamBuf buffer(sink);
+    std::ostream out(&buffer);
+    writeDocument(out, asciiData, config, scheme);
+    out.flush();
+    if (!out || sink.failed()) {
+        LOG_ERROR << "Error: Failed to write SVG to " << sink.describe();
+        return false;
+    }
+    return true;
+}
+
+void SvgRenderer::writeDocument(std::ostream& out,
+    const std::vector<std::vector<CharColorInfo>>& asciiData,
+    const Config& config,
+    ColorScheme scheme) const
+{
+    unsigned char schemeBgColor[3], schemeFgColor[3];
+    RenderUtils::setSchemeColors(scheme, schemeBgColor, schemeFgColor);
+    bool usePixelColor = RenderUtils::usesPixelColor(scheme);
+
+    const double fontSizePx = config.fontSize;
+    const double charWidthPx = fontSizePx * SVG_CHAR_WIDTH_EM;
+    const double lineHeightPx = fontSizePx;
+    const size_t asciiWidth = asciiData[0].size();
+    const double rowWidthPx = asciiWidth * charWidthPx;
+    const double imageHeightPx = asciiData.size() * lineHeightPx;
+
+    out << std::fixed << std::setprecision(2);
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << rowWidthPx << "\" height=\"" << imageHeightPx
+        << "\" viewBox=\"0 0 " << rowWidthPx << " " << imageHeightPx << "\">\n";
+    // 字体名来自配置（字体文件名），写入 <style> 前同样需要转义，否则 '<'、'&' 会破坏文档
+    std::string fontFamilyList;
+    for (char c : RenderUtils::getFontFamilyList(config)) {
+        appendEscapedXmlChar(fontFamilyList, c);
+    }
+    out << "<style>\n";
+    out << "  text {\n";
+    out << "    font-family: " << fontFamilyList << ";\n";
+    out << "    font-size: " << fontSizePx << "px;\n";
+    out << "    white-space: pre;\n";
+    out << "  }\n";
+    out << "</style>\n";
+    out << "<rect width=\"100%\" height=\"100%\" fill=\"" << RenderUtils::rgbToHex(schemeBgColor) << "\"/>\n";
+    out << "<g fill=\"" << RenderUtils::rgbToHex(schemeFgColor) << "\" xml:space=\"preserve\">\n";
+
+    // 每行只生成一个 <text>，先在内存中拼好再一次性写入
+    std::string rowBuffer;
+    rowBuffer.reserve(usePixelColor ? asciiWidth * 32 : asciiWidth + 128);
+    char textOpenTag[128];
+    double baselineY = lineHeightPx * SVG_BASELINE_EM;
+
+    for (const auto& lineData : asciiData) {
+        rowBuffer.clear();
+        std::snprintf(textOpenTag, sizeof(textOpenTag), "<text x=\"0\" y=\"%.2f\" textLength=\"%.2f\" lengthAdjust=\"spacing\">",
+                      baselineY, rowWidthPx);
+        rowBuffer += textOpenTag;
+        if (usePixelColor) {
+            appendColoredRow(rowBuffer, lineData);
+        } else {
+            for (const auto& charInfo : lineData) {
+                appendEscapedXmlChar(rowBuffer, charInfo.character);
+            }
+        }
+        rowBuffer += "</text>\n";
+        out.write(rowBuffer.data(), static_cast<std::streamsize>(rowBuffer.size()));
+        baselineY += lineHeightPx;
+    }
+
+    out << "</g>\n";
+    out << "</svg>\n";
+}
+
+std::string SvgRenderer::getOutputFileExtension() const {
+    return ".svg";
+}
@@ -0,0 +1,24 @@
+#ifndef SVG_RENDERER_H
+#define SVG_RENDERER_H
+
+#include "IRenderer.h"
+#include <ostream>
+
+class SvgRenderer : public IRenderer {
+public:
+    bool render(
+        const std::vector<std::vector<CharColorInfo>>& asciiData,
+        OutputSink& sink,
+        const Config& config,
+        ColorScheme scheme) const override;
+
+    std::string getOutputFileExtension() const override;
+
+private:
+    void writeDocument(std::ostream& out,
+        const std::vector<std::vector<CharColorInfo>>& asciiData,
+        const Config& config,
+        ColorScheme scheme) const;
+};
+
+#endif // SVG_RENDERER_H
\ No newline at end of file
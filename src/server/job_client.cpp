@@ -0,0 +1,46 @@
+#include "job_client.h"
+#include "socket_io.h"
+
+#include <nlohmann/json.hpp>
+#include <iostream>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <unistd.h>
+#endif
+
+using json = nlohmann::json;
+
+namespace JobClient {
+
+int submit(const std::string& socketPath, std::istream& jobs, std::ostream& out) {
+    int fd = SocketIO::connectUnix(socketPath);
+    if (fd < 0) {
+        return 1;
+    }
+
+    int failures = 0;
+    std::string pending;
+    std::string request;
+    std::string response;
+    while (std::getline(jobs, request)) {
+        if (request.empty() || request.find_first_not_of(" \t\r") == std::string::npos) continue;
+        if (!SocketIO::writeAll(fd, request + "\n") || !SocketIO::readLine(fd, pending, response)) {
+            std::cerr << "Error: Connection to " << socketPath << " was closed unexpectedly." << std::endl;
+            failures++;
+            break;
+        }
+        out << response << std::endl;
+
+        json parsed = json::parse(response, nullptr, false);
+        if (parsed.is_discarded() || !parsed.value("ok", false)) {
+            failures++;
+        }
+    }
+
+#if !defined(_WIN32) && !defined(_WIN64)
+    close(fd);
+#endif
+    return failures > 0 ? 1 : 0;
+}
+
+} // namespace JobClient
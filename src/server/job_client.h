@@ -0,0 +1,16 @@
+#ifndef JOB_CLIENT_H
+#define JOB_CLIENT_H
+
+#include <istream>
+#include <ostream>
+#include <string>
+
+namespace JobClient {
+
+    // 连接到服务端，逐行发送 jobs 中的 JSON 请求，并把每行响应写到 out。
+    // 全部请求成功时返回 0。
+    int submit(const std::string& socketPath, std::istream& jobs, std::ostream& out);
+
+} // namespace JobClient
+
+#endif // JOB_CLIENT_H
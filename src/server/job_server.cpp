@@ -0,0 +1,355 @@
+#include "job_server.h"
+#include "socket_io.h"
+#include "conversion/image_converter.h"
+#include "conversion/ascii_grid_file.h"
+#include "rendering/PngRenderer.h"
+#include "rendering/HtmlRenderer.h"
+#include "rendering/SvgRenderer.h"
+#include "utils/Base64.h"
+#include "utils/ContentHash.h"
+#include "utils/MappedFile.h"
+#include "utils/Logger.h"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using json = nlohmann::json;
+using namespace std::chrono;
+
+namespace {
+
+std::atomic<bool> g_stopRequested{false};
+
+void onStopSignal(int) {
+    g_stopRequested = true;
+}
+
+// 请求参数错误等可预期的失败，消息原样返回给客户端
+struct JobError : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+// 每个请求可指定字号：PNG 渲染器为每个字号栅格化一套字形图集，过大的字号会占用大量内存
+constexpr float MIN_JOB_FONT_SIZE = 4.0f;
+constexpr float MAX_JOB_FONT_SIZE = 256.0f;
+
+json makeErrorResponse(const json& id, const std::string& message) {
+    return {{"id", id}, {"ok", false}, {"error", message}};
+}
+
+} // end anonymous namespace
+
+JobServer::JobServer(const Config& config)
+    : m_config(config), m_pool(config.workerThreads > 0 ? static_cast<size_t>(config.workerThreads) : 0) {
+    m_renderers["png"] = std::make_unique<PngRenderer>();
+    m_renderers["html"] = std::make_unique<HtmlRenderer>();
+    m_renderers["svg"] = std::make_unique<SvgRenderer>();
+    if (!m_config.conversionCacheDir.empty()) {
+        uint64_t maxBytes = static_cast<uint64_t>(std::max(0, m_config.conversionCacheMaxMB)) * 1024 * 1024;
+        m_cache = std::make_unique<ConversionCache>(m_config.conversionCacheDir, maxBytes);
+    }
+}
+
+std::string JobServer::handleRequest(const std::string& requestLine) {
+    auto start = steady_clock::now();
+    json request = json::parse(requestLine, nullptr, false);
+    if (request.is_discarded() || !request.is_object()) {
+        return makeErrorResponse(nullptr, "Request is not a valid JSON object.").dump();
+    }
+    const json id = request.value("id", json());
+
+    try {
+        // --- 每个任务在服务端配置的副本上覆盖参数 ---
+        Config jobConfig = m_config;
+        jobConfig.targetWidth = request.value("width", jobConfig.targetWidth);
+        jobConfig.charAspectRatioCorrection = request.value("aspectRatio", jobConfig.charAspectRatioCorrection);
+        jobConfig.fontSize = request.value("fontSize", jobConfig.fontSize);
+        if (jobConfig.targetWidth <= 0 || jobConfig.charAspectRatioCorrection <= 0 || jobConfig.fontSize <= 0) {
+            throw JobError("width, aspectRatio and fontSize must be positive.");
+        }
+        if (jobConfig.fontSize < MIN_JOB_FONT_SIZE || jobConfig.fontSize > MAX_JOB_FONT_SIZE) {
+            throw JobError("fontSize must be between " + std::to_string(static_cast<int>(MIN_JOB_FONT_SIZE)) + " and " +
+                           std::to_string(static_cast<int>(MAX_JOB_FONT_SIZE)) + ".");
+        }
+        if (request.contains("schemes")) {
+            jobConfig.schemesToGenerate.clear();
+            const auto& schemeMap = getColorSchemeMap();
+            for (const auto& name : request.at("schemes").get<std::vector<std::string>>()) {
+                auto it = schemeMap.find(toLower(name));
+                if (it == schemeMap.end()) {
+                    throw JobError("Unknown color scheme '" + name + "'.");
+                }
+                jobConfig.schemesToGenerate.push_back(it->second);
+            }
+        }
+
+        const auto outputTypes = request.value("outputs", std::vector<std::string>{"png"});
+        bool writeGrid = false;
+        for (const auto& type : outputTypes) {
+            if (type == "agrid") {
+                writeGrid = true;
+            } else if (!m_renderers.count(type)) {
+                throw JobError("Unknown output type '" + type + "'. Expected png, html, svg or agrid.");
+            }
+        }
+
+        const std::string outputDirText = request.value("outputDir", std::string());
+        if (outputDirText.empty()) {
+            throw JobError("outputDir is required.");
+        }
+        const std::filesystem::path outputDir(outputDirText);
+        std::error_code ec;
+        std::filesystem::create_directories(outputDir, ec);
+        if (ec) {
+            throw JobError("Cannot create outputDir: " + ec.message());
+        }
+
+        // --- 读取输入并转换 ---
+        std::string name = request.value("name", std::string());
+        std::vector<unsigned char> decodedBytes;
+        MappedFile mappedInput;
+        const unsigned char* sourceData = nullptr;
+        size_t sourceSize = 0;
+        std::optional<AsciiConversionResult> conversion;
+        if (request.contains("inputBase64")) {
+            auto decoded = Base64::decode(request.at("inputBase64").get<std::string>());
+            if (!decoded || decoded->empty()) {
+                throw JobError("inputBase64 is not valid Base64 data.");
+            }
+            decodedBytes = std::move(*decoded);
+            sourceData = decodedBytes.data();
+            sourceSize = decodedBytes.size();
+            if (name.empty()) name = "job";
+        } else if (request.contains("input")) {
+            const std::filesystem::path inputPath(request.at("input").get<std::string>());
+            if (name.empty()) name = inputPath.stem().string();
+            if (isAsciiGridFile(inputPath)) {
+                conversion = loadAsciiGridFile(inputPath);
+            } else {
+                // 映射输入并直接解码，不复制到堆上
+                if (!mappedInput.open(inputPath, MappedFile::Access::Sequential) || mappedInput.size() == 0) {
+                    throw JobError("Cannot read input '" + inputPath.string() + "'.");
+                }
+                sourceData = mappedInput.data();
+                sourceSize = mappedInput.size();
+            }
+        } else {
+            throw JobError("Either input or inputBase64 is required.");
+        }
+
+        if (sourceSize > 0) {
+            uint64_t sourceHash = ContentHash::hashBytes(sourceData, sourceSize);
+            uint64_t cacheKey = ConversionCache::makeKey(sourceHash, jobConfig.targetWidth, jobConfig.charAspectRatioCorrection);
+            if (m_cache && m_cache->isEnabled()) {
+                conversion = m_cache->lookup(cacheKey);
+            }
+            if (!conversion) {
+                conversion = convertImageBytesToAscii(sourceData, sourceSize, name,
+                                                      jobConfig.targetWidth, jobConfig.charAspectRatioCorrection);
+                if (conversion) {
+                    conversion->sourceHash = sourceHash;
+                    if (m_cache && m_cache->isEnabled()) {
+                        m_cache->store(cacheKey, *conversion);
+                    }
+                }
+            }
+        }
+        if (!conversion) {
+            throw JobError("Failed to decode or convert the input image.");
+        }
+
+        // --- 渲染请求的输出 ---
+        json outputs = json::array();
+        if (writeGrid) {
+            std::filesystem::path gridPath = outputDir / (name + ASCII_GRID_EXTENSION);
+            if (!writeAsciiGridFile(*conversion, gridPath)) {
+                throw JobError("Failed to write " + gridPath.string());
+            }
+            outputs.push_back(gridPath.string());
+        }
+        for (const auto& scheme : jobConfig.schemesToGenerate) {
+            for (const auto& type : outputTypes) {
+                auto it = m_renderers.find(type);
+                if (it == m_renderers.end()) continue;
+                const IRenderer& renderer = *it->second;
+                std::filesystem::path outputPath = outputDir / (name + getSchemeSuffix(scheme) + renderer.getOutputFileExtension());
+                if (!renderer.renderToFile(conversion->data, outputPath, jobConfig, scheme)) {
+                    throw JobError("Failed to render " + outputPath.string());
+                }
+                outputs.push_back(outputPath.string());
+            }
+        }
+
+        json response = {
+            {"id", id},
+            {"ok", true},
+            {"outputs", std::move(outputs)},
+            {"asciiWidth", conversion->asciiWidth},
+            {"asciiHeight", conversion->asciiHeight},
+            {"elapsedMs", duration_cast<duration<double, std::milli>>(steady_clock::now() - start).count()}
+        };
+        return response.dump();
+    } catch (const JobError& e) {
+        return makeErrorResponse(id, e.what()).dump();
+    } catch (const std::exception& e) {
+        return makeErrorResponse(id, std::string("Invalid request: ") + e.what()).dump();
+    }
+}
+
+#if !defined(_WIN32) && !defined(_WIN64)
+
+JobServer::Connection::~Connection() {
+    close(fd);
+}
+
+void JobServer::submitRequest(const std::shared_ptr<Connection>& connection, std::string requestLine) {
+    m_pool.submit([this, connection, requestLine = std::move(requestLine)] {
+        const std::string response = handleRequest(requestLine) + "\n";
+        std::lock_guard<std::mutex> lock(connection->writeMutex);
+        if (!connection->writeFailed && !SocketIO::writeAll(connection->fd, response)) {
+            connection->writeFailed = true;
+        }
+    });
+}
+
+bool JobServer::readRequests(const std::shared_ptr<Connection>& connection) {
+    char chunk[64 * 1024];
+    ssize_t received = recv(connection->fd, chunk, sizeof(chunk), 0);
+    if (received < 0) {
+        return errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    std::string& pending = connection->pending;
+    if (received == 0) {
+        // 对端关闭：最后一行可以没有换行符。已提交的请求仍会写回响应（半关闭的连接仍可写）
+        if (!pending.empty()) {
+            submitRequest(connection, std::move(pending));
+            pending.clear();
+        }
+        return false;
+    }
+    pending.append(chunk, static_cast<size_t>(received));
+
+    size_t lineStart = 0;
+    size_t newline;
+    while ((newline = pending.find('\n', std::max(lineStart, connection->scannedBytes))) != std::string::npos) {
+        if (newline > lineStart) {
+            submitRequest(connection, pending.substr(lineStart, newline - lineStart));
+        }
+        lineStart = newline + 1;
+    }
+    pending.erase(0, lineStart);
+    connection->scannedBytes = pending.size();
+    if (pending.size() > SocketIO::MAX_LINE_BYTES) {
+        LOG_ERROR << "Error: Request line exceeds " << SocketIO::MAX_LINE_BYTES << " bytes.";
+        return false;
+    }
+    return true;
+}
+
+int JobServer::run(const std::string& socketPath) {
+    sockaddr_un address{};
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        LOG_ERROR << "Error: Socket path is too long: " << socketPath;
+        return 1;
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    // 上次异常退出留下的套接字文件会导致 bind 失败；只删除套接字，不碰普通文件
+    std::error_code ec;
+    if (std::filesystem::is_socket(socketPath, ec)) {
+        std::filesystem::remove(socketPath, ec);
+    }
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        LOG_ERROR << "Error: Cannot create socket: " << std::strerror(errno);
+        return 1;
+    }
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listenFd, 64) != 0) {
+        LOG_ERROR << "Error: Cannot listen on " << socketPath << ": " << std::strerror(errno);
+        close(listenFd);
+        return 1;
+    }
+
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+    LOG_INFO << "Serving conversion jobs on " << socketPath << " with " << m_pool.getThreadCount()
+             << " worker thread(s). Press Ctrl+C to stop.";
+
+    // 单个线程轮询监听套接字和所有连接：空闲连接不占用工作线程，线程池只执行请求本身
+    std::map<int, std::shared_ptr<Connection>> connections;
+    std::vector<pollfd> pollSet;
+    while (!g_stopRequested) {
+        pollSet.clear();
+        pollSet.push_back({listenFd, POLLIN, 0});
+        for (const auto& entry : connections) {
+            pollSet.push_back({entry.first, POLLIN, 0});
+        }
+        int ready = poll(pollSet.data(), pollSet.size(), 500);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR << "Error: poll() failed: " << std::strerror(errno);
+            break;
+        }
+        if (ready == 0) continue;
+
+        for (size_t i = 1; i < pollSet.size(); ++i) {
+            if (pollSet[i].revents == 0) continue;
+            auto it = connections.find(pollSet[i].fd);
+            // 读取结束后由仍在处理的请求持有连接，全部响应写完后关闭
+            if ((pollSet[i].revents & (POLLIN | POLLHUP | POLLERR)) && !readRequests(it->second)) {
+                connections.erase(it);
+            }
+        }
+
+        if (pollSet[0].revents & POLLIN) {
+            int clientFd = accept(listenFd, nullptr, nullptr);
+            if (clientFd < 0) {
+                if (errno != EINTR && errno != EAGAIN) {
+                    LOG_WARN << "Warning: accept() failed: " << std::strerror(errno);
+                }
+                continue;
+            }
+            connections.emplace(clientFd, std::make_shared<Connection>(clientFd));
+        }
+    }
+
+    LOG_INFO << "Shutting down server...";
+    close(listenFd);
+    std::filesystem::remove(socketPath, ec);
+    m_pool.waitIdle();
+    connections.clear();
+    return 0;
+}
+
+#else
+
+JobServer::Connection::~Connection() {}
+
+bool JobServer::readRequests(const std::shared_ptr<Connection>&) { return false; }
+
+void JobServer::submitRequest(const std::shared_ptr<Connection>&, std::string) {}
+
+int JobServer::run(const std::string&) {
+    LOG_ERROR << "Error: --serve requires Unix domain sockets and is not supported on this platform.";
+    return 1;
+}
+
+#endif
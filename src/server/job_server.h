@@ -0,0 +1,60 @@
+#ifndef JOB_SERVER_H
+#define JOB_SERVER_H
+
+#include "common/common_types.h"
+#include "core/conversion_cache.h"
+#include "core/thread_pool.h"
+#include "rendering/IRenderer.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// 常驻服务模式：在 Unix 域套接字上接受转换任务。
+// 配置、字体图集、线程池和转换缓存在启动时准备一次，之后每个任务只付出解码、转换和渲染的开销。
+//
+// 协议：每个连接上按行传输 JSON，一行请求对应一行响应。
+// 同一连接上连续发送的多个请求会并行处理，响应按完成顺序返回，客户端用 id 对应请求。
+//   请求：{"id": 任意, "input": "/path/img.png" | "inputBase64": "...", "outputDir": "/out",
+//          "name": "cat", "width": 256, "aspectRatio": 2.0, "fontSize": 12,
+//          "schemes": ["BlackOnWhite"], "outputs": ["png", "html", "svg", "agrid"]}
+//   响应：{"id": ..., "ok": true, "outputs": [...], "asciiWidth": W, "asciiHeight": H, "elapsedMs": t}
+//         或 {"id": ..., "ok": false, "error": "..."}
+class JobServer {
+public:
+    explicit JobServer(const Config& config);
+
+    // 阻塞运行直到收到 SIGINT/SIGTERM，返回进程退出码
+    int run(const std::string& socketPath);
+
+    // 处理一行 JSON 请求并返回一行 JSON 响应（不含换行）
+    std::string handleRequest(const std::string& requestLine);
+
+private:
+    // 一个客户端连接。读取只在 run() 的轮询线程中进行；每个请求行作为独立任务交给线程池，
+    // 工作线程持有连接的引用并在写锁下写回响应。最后一个引用释放时关闭套接字。
+    struct Connection {
+        explicit Connection(int fd) : fd(fd) {}
+        ~Connection();
+        Connection(const Connection&) = delete;
+        Connection& operator=(const Connection&) = delete;
+
+        const int fd;
+        std::string pending;     // 已读取但还不是完整一行的数据
+        size_t scannedBytes = 0; // pending 中已确认不含换行符的前缀长度
+        std::mutex writeMutex;
+        bool writeFailed = false; // 受 writeMutex 保护；对端已断开时不再尝试写入
+    };
+
+    // 读取连接上的可用数据并提交其中的完整请求行；对端关闭或出错时返回 false
+    bool readRequests(const std::shared_ptr<Connection>& connection);
+    void submitRequest(const std::shared_ptr<Connection>& connection, std::string requestLine);
+
+    const Config& m_config;
+    std::map<std::string, std::unique_ptr<IRenderer>> m_renderers; // 以输出类型 "png"/"html"/"svg" 为键
+    std::unique_ptr<ConversionCache> m_cache;
+    ThreadPool m_pool;
+};
+
+#endif // JOB_SERVER_H
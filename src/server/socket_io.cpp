@@ -0,0 +1,95 @@
+#include "socket_io.h"
+#include "utils/Logger.h"
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace SocketIO {
+
+#if !defined(_WIN32) && !defined(_WIN64)
+
+bool readLine(int fd, std::string& pending, std::string& line) {
+    size_t searchFrom = 0;
+    for (;;) {
+        size_t newline = pending.find('\n', searchFrom);
+        if (newline != std::string::npos) {
+            line.assign(pending, 0, newline);
+            pending.erase(0, newline + 1);
+            return true;
+        }
+        searchFrom = pending.size();
+        if (pending.size() > MAX_LINE_BYTES) {
+            LOG_ERROR << "Error: Response line exceeds " << MAX_LINE_BYTES << " bytes.";
+            return false;
+        }
+
+        char chunk[64 * 1024];
+        ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (received == 0) {
+            // 对端关闭：最后一行可以没有换行符
+            if (pending.empty()) return false;
+            line.swap(pending);
+            pending.clear();
+            return true;
+        }
+        pending.append(chunk, static_cast<size_t>(received));
+    }
+}
+
+bool writeAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+int connectUnix(const std::string& socketPath) {
+    sockaddr_un address{};
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        LOG_ERROR << "Error: Socket path is too long: " << socketPath;
+        return -1;
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        LOG_ERROR << "Error: Cannot create socket: " << std::strerror(errno);
+        return -1;
+    }
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        LOG_ERROR << "Error: Cannot connect to " << socketPath << ": " << std::strerror(errno);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+#else
+
+bool readLine(int, std::string&, std::string&) { return false; }
+bool writeAll(int, const std::string&) { return false; }
+
+int connectUnix(const std::string&) {
+    LOG_ERROR << "Error: Unix domain sockets are not supported on this platform.";
+    return -1;
+}
+
+#endif
+
+} // namespace SocketIO
@@ -0,0 +1,23 @@
+#ifndef SOCKET_IO_H
+#define SOCKET_IO_H
+
+#include <string>
+
+// Unix 域套接字读写辅助函数（仅 POSIX）。服务端在自己的轮询线程中读取请求，只共用 writeAll 和行长度上限
+namespace SocketIO {
+
+    // 单行请求/响应的大小上限（内联图片以 Base64 传输，需要留足空间）
+    constexpr size_t MAX_LINE_BYTES = 256 * 1024 * 1024;
+
+    // 客户端使用：阻塞地从 fd 读取一行（不含 '\n'）。pending 保存已读取但尚未消费的数据，
+    // 需在同一连接的多次调用间保留。对端关闭、出错或超过上限时返回 false。
+    bool readLine(int fd, std::string& pending, std::string& line);
+
+    bool writeAll(int fd, const std::string& data);
+
+    // 连接到 socketPath，失败时打印原因并返回 -1
+    int connectUnix(const std::string& socketPath);
+
+} // namespace SocketIO
+
+#endif // SOCKET_IO_H
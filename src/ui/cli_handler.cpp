@@ -11,14 +11,240 @@ void printWelcomeMessage() {
     std::cout << "--- ASCII Art Generator ---" << std::endl;
 }
 
+namespace {
+
+// 解析 "i/N"，要求 N >= 1 且 0 <= i < N
+bool parseShardSpec(const std::string& text, ShardSpec& shard) {
+    size_t slash = text.find('/');
+    if (slash == std::string::npos) return false;
+    try {
+        size_t consumed = 0;
+        int index = std::stoi(text.substr(0, slash), &consumed);
+        if (consumed != slash) return false;
+        std::string countText = text.substr(slash + 1);
+        int count = std::stoi(countText, &consumed);
+        if (consumed != countText.size() || count < 1 || index < 0 || index >= count) return false;
+        shard.index = index;
+        shard.count = count;
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+} // end anonymous namespace
+
+bool parseCommandLine(int argc, char* argv[], CommandLineOptions& options) {
+    int first = 1;
+    if (argc > 1 && std::string(argv[1]) == "merge") {
+        options.mergeShards = true;
+        first = 2;
+    } else if (argc > 1 && std::string(argv[1]) == "client") {
+        // client <socket> [request-json]：请求 JSON 不经过选项解析
+        options.clientMode = true;
+        if (argc < 3 || argc > 4) {
+            std::cerr << "Error: client expects a socket path and an optional JSON request." << std::endl;
+            return false;
+        }
+        options.inputPath = argv[2];
+        if (argc == 4) options.clientRequest = argv[3];
+        return true;
+    }
+    for (int i = first; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            options.showHelp = true;
+        } else if (arg == "--files-from") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --files-from requires a file name or '-' for stdin." << std::endl;
+                return false;
+            }
+            options.filesFrom = argv[++i];
+        } else if (arg.rfind("--files-from=", 0) == 0) {
+            options.filesFrom = arg.substr(std::string("--files-from=").size());
+        } else if (arg == "--shard" || arg.rfind("--shard=", 0) == 0) {
+            std::string spec;
+            if (arg == "--shard") {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: --shard requires a value like 0/4." << std::endl;
+                    return false;
+                }
+                spec = argv[++i];
+            } else {
+                spec = arg.substr(std::string("--shard=").size());
+            }
+            if (!parseShardSpec(spec, options.shard)) {
+                std::cerr << "Error: Invalid shard '" << spec << "'. Expected i/N with 0 <= i < N." << std::endl;
+                return false;
+            }
+        } else if (arg == "--serve") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --serve requires a socket path." << std::endl;
+                return false;
+            }
+            options.serveSocket = argv[++i];
+        } else if (arg == "--to" || arg.rfind("--to=", 0) == 0) {
+            if (arg == "--to") {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: --to requires an output format (png, html or svg)." << std::endl;
+                    return false;
+                }
+                options.streamFormat = toLower(argv[++i]);
+            } else {
+                options.streamFormat = toLower(arg.substr(std::string("--to=").size()));
+            }
+            if (options.streamFormat != "png" && options.streamFormat != "html" && options.streamFormat != "svg") {
+                std::cerr << "Error: Unknown output format '" << options.streamFormat << "'. Use png, html or svg." << std::endl;
+                return false;
+            }
+        } else if (arg == "-0" || arg == "--null") {
+            options.nulSeparated = true;
+        } else if (arg == "-q" || arg == "--quiet") {
+            options.verbosity = -1;
+        } else if (arg == "-v" || arg == "--verbose") {
+            options.verbosity = 1;
+        } else if (arg == "--log-format" || arg.rfind("--log-format=", 0) == 0) {
+            std::string format;
+            if (arg == "--log-format") {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: --log-format requires text or json." << std::endl;
+                    return false;
+                }
+                format = toLower(argv[++i]);
+            } else {
+                format = toLower(arg.substr(std::string("--log-format=").size()));
+            }
+            if (format != "text" && format != "json") {
+                std::cerr << "Error: Unknown log format '" << format << "'. Use text or json." << std::endl;
+                return false;
+            }
+            options.jsonLog = format == "json";
+        } else if (arg == "--trace") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --trace requires an output file." << std::endl;
+                return false;
+            }
+            options.traceFile = argv[++i];
+        } else if (arg.rfind("--trace=", 0) == 0) {
+            options.traceFile = arg.substr(std::string("--trace=").size());
+        } else if (arg == "--report") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --report requires an output file." << std::endl;
+                return false;
+            }
+            options.reportFile = argv[++i];
+        } else if (arg.rfind("--report=", 0) == 0) {
+            options.reportFile = arg.substr(std::string("--report=").size());
+        } else if (arg == "--perf-counters") {
+            options.perfCounters = true;
+        } else if (arg == "--track-allocations") {
+            options.trackAllocations = true;
+        } else if (arg == "--progress") {
+            options.progress = true;
+        } else if (arg == "--status-file") {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: --status-file requires an output file." << std::endl;
+                return false;
+            }
+            options.statusFile = argv[++i];
+        } else if (arg.rfind("--status-file=", 0) == 0) {
+            options.statusFile = arg.substr(std::string("--status-file=").size());
+        } else if (arg.size() > 1 && arg[0] == '-' && arg != "-") {
+            std::cerr << "Error: Unknown option '" << arg << "'." << std::endl;
+            return false;
+        } else if (options.inputPath.empty()) {
+            options.inputPath = arg;
+        } else {
+            std::cerr << "Error: Unexpected extra argument '" << arg << "'." << std::endl;
+            return false;
+        }
+    }
+
+    if (options.showHelp) {
+        return true;
+    }
+    if (options.mergeShards) {
+        if (options.inputPath.empty() || !options.filesFrom.empty() || options.shard.isSharded() || !options.streamFormat.empty()) {
+            std::cerr << "Error: merge expects exactly one batch output directory." << std::endl;
+            return false;
+        }
+        return true;
+    }
+    if (!options.serveSocket.empty()) {
+        if (!options.inputPath.empty() || !options.filesFrom.empty() || options.shard.isSharded() || !options.streamFormat.empty()) {
+            std::cerr << "Error: --serve cannot be combined with input paths, --files-from, --shard or --to." << std::endl;
+            return false;
+        }
+        return true;
+    }
+    if (!options.streamFormat.empty()) {
+        if (options.inputPath.empty() || !options.filesFrom.empty() || options.shard.isSharded() || options.nulSeparated) {
+            std::cerr << "Error: --to expects exactly one input image (or '-' for stdin)." << std::endl;
+            return false;
+        }
+        return true;
+    }
+    if (options.inputPath == "-") {
+        std::cerr << "Error: Reading an image from stdin requires --to <format>." << std::endl;
+        return false;
+    }
+    if (!options.filesFrom.empty() && !options.inputPath.empty()) {
+        std::cerr << "Error: Use either an input path or --files-from, not both." << std::endl;
+        return false;
+    }
+    if (options.filesFrom.empty() && options.inputPath.empty()) {
+        std::cerr << "Error: No input specified." << std::endl;
+        return false;
+    }
+    if (options.nulSeparated && options.filesFrom.empty()) {
+        std::cerr << "Error: -0 can only be used together with --files-from." << std::endl;
+        return false;
+    }
+    return true;
+}
+
 // 新增：实现 printUsage 函数
 void printUsage(const std::string& programName) {
     std::cerr << "\nA command-line tool to convert images to ASCII art (PNG and HTML)." << std::endl;
     std::cerr << "\nUsage:\n  " << programName << " <path_to_image_or_directory>" << std::endl;
+    std::cerr << "  " << programName << " --files-from <list.txt|-> [-0]" << std::endl;
+    std::cerr << "  " << programName << " merge <batch_output_directory>" << std::endl;
+    std::cerr << "  " << programName << " <path_to_image|-> --to <png|html|svg> > output" << std::endl;
+    std::cerr << "  " << programName << " --serve <socket_path>" << std::endl;
+    std::cerr << "  " << programName << " client <socket_path> [request_json]" << std::endl;
     std::cerr << "\nArguments:" << std::endl;
     std::cerr << "  path_to_image_or_directory   The full path to a single image file or a directory of images." << std::endl;
+    std::cerr << "                               Previously saved .agrid files are rendered directly without decoding." << std::endl;
+    std::cerr << "                               A .tar archive is read sequentially and its images are decoded from memory." << std::endl;
+    std::cerr << "\nOptions:" << std::endl;
+    std::cerr << "  --files-from <file|->        Process the image paths listed in a file ('-' reads stdin), one per line." << std::endl;
+    std::cerr << "                               Paths are processed as they are read." << std::endl;
+    std::cerr << "  -0, --null                   List entries are separated by NUL characters (e.g. find -print0)." << std::endl;
+    std::cerr << "  --shard <i/N>                Only process inputs whose relative path hashes to shard i of N." << std::endl;
+    std::cerr << "                               Each shard writes its own manifest and report fragment." << std::endl;
+    std::cerr << "  merge <dir>                  Combine the shard report/manifest fragments in a batch output directory." << std::endl;
+    std::cerr << "  --to <png|html|svg>          Render a single image ('-' reads stdin) with the first configured scheme" << std::endl;
+    std::cerr << "                               and write it to stdout. No output directory is created; logs go to stderr." << std::endl;
+    std::cerr << "  --serve <socket>             Run as a daemon accepting JSON conversion jobs on a Unix socket." << std::endl;
+    std::cerr << "  client <socket> [json]       Send one JSON job (or one job per stdin line) to a running daemon." << std::endl;
+    std::cerr << "  -q, --quiet                  Only print warnings and errors." << std::endl;
+    std::cerr << "  -v, --verbose                Also print the per-image and per-scheme steps." << std::endl;
+    std::cerr << "  --log-format <text|json>     With json, every log message is one JSON object per line on stderr." << std::endl;
+    std::cerr << "  --trace <file>               Record per-stage spans on every thread and write them as Chrome trace JSON" << std::endl;
+    std::cerr << "                               (open in Perfetto or chrome://tracing)." << std::endl;
+    std::cerr << "  --report <file>              Write per-image metrics (size, stage times, bytes, errors) plus throughput" << std::endl;
+    std::cerr << "                               and latency percentiles as JSON." << std::endl;
+    std::cerr << "  --perf-counters              Add per-stage cycles, instructions, cache and branch misses (Linux perf" << std::endl;
+    std::cerr << "                               counters) to the --report output when the kernel allows it." << std::endl;
+    std::cerr << "  --progress                   Show completed/running/queued images, images/s, MP/s and ETA during batch" << std::endl;
+    std::cerr << "                               runs (a live status line on a terminal, otherwise a log line every 10s)." << std::endl;
+    std::cerr << "  --status-file <file>         Rewrite a JSON progress snapshot every second during batch runs." << std::endl;
+    std::cerr << "  --track-allocations          Count heap allocations, bytes and peak live bytes per stage and per image;" << std::endl;
+    std::cerr << "                               printed after the summary and added to the --report output." << std::endl;
+    std::cerr << "  -h, --help                   Show this help." << std::endl;
     std::cerr << "\nExample:" << std::endl;
     std::cerr << "  " << programName << " C:\\Users\\MyUser\\Pictures\\MyCat.jpg" << std::endl;
+    std::cerr << "  find photos -name '*.jpg' -print0 | " << programName << " --files-from - -0" << std::endl;
 }
 
 
@@ -31,6 +257,20 @@ void printEffectiveConfiguration(const Config& config) {
     std::cout << "--- HTML Settings ---" << std::endl;
     std::cout << "Generate HTML Output: " << (config.generateHtmlOutput ? "Enabled" : "Disabled") << std::endl;
     std::cout << "HTML Font Size:       " << config.htmlFontSizePt << "pt" << std::endl;
+    std::cout << "--- SVG Settings ---" << std::endl;
+    std::cout << "Generate SVG Output:  " << (config.generateSvgOutput ? "Enabled" : "Disabled") << std::endl;
+    std::cout << "Write ASCII Grid:     " << (config.writeAsciiGrid ? "Enabled" : "Disabled") << std::endl;
+    std::cout << "Incremental Batch:    " << (config.incrementalBatch ? "Enabled" : "Disabled") << std::endl;
+    std::cout << "Deduplicate Inputs:   " << (config.deduplicateInputs ? "Enabled" : "Disabled") << std::endl;
+    std::cout << "Recursive Scan:       " << (config.recursiveScan ? "Enabled" : "Disabled")
+              << (config.followSymlinks ? " (following symlinks)" : "") << std::endl;
+    if (!config.includePatterns.empty() || !config.excludePatterns.empty()) {
+        std::cout << "Include/Exclude:      " << config.includePatterns.size() << " / " << config.excludePatterns.size() << " pattern(s)" << std::endl;
+    }
+    std::cout << "Worker Threads:       " << (config.workerThreads > 0 ? std::to_string(config.workerThreads) : "auto") << std::endl;
+    std::cout << "Input Prefetch:       " << (config.prefetchBudgetMB > 0 ? std::to_string(config.prefetchBudgetMB) + " MB" : "Disabled") << std::endl;
+    std::cout << "Archive Outputs:      " << (config.archiveBatchOutputs ? "Enabled" : "Disabled") << std::endl;
+    std::cout << "Conversion Cache:     " << (config.conversionCacheDir.empty() ? "Disabled" : config.conversionCacheDir + " (max " + std::to_string(config.conversionCacheMaxMB) + " MB)") << std::endl;
     std::cout << "--- Schemes ---" << std::endl;
     std::cout << "Color Schemes:        ";
     if (config.schemesToGenerate.empty()) {
@@ -43,11 +283,20 @@ void printEffectiveConfiguration(const Config& config) {
     std::cout << "\n-----------------------------" << std::endl;
 }
 
-void printProcessingSummary(int processedCount, int failedCount, double duration, const std::filesystem::path& outputDir) {
+void printProcessingSummary(const ProcessingStats& stats, double duration, const std::filesystem::path& outputDir) {
     std::cout << "\n==================================================" << std::endl;
     std::cout << "Processing Summary:" << std::endl;
-    std::cout << "  Successfully processed: " << processedCount << " image(s)" << std::endl;
-    std::cout << "  Failed/Skipped:       " << failedCount << " image(s)" << std::endl;
+    std::cout << "  Successfully processed: " << stats.processedCount << " image(s)" << std::endl;
+    std::cout << "  Failed/Skipped:       " << stats.failedCount << " image(s)" << std::endl;
+    if (stats.duplicateCount > 0) {
+        std::cout << "  Duplicates (linked):  " << stats.duplicateCount << " image(s)" << std::endl;
+    }
+    if (stats.unchangedCount > 0) {
+        std::cout << "  Unchanged (skipped):  " << stats.unchangedCount << " image(s)" << std::endl;
+    }
+    if (stats.cacheEnabled) {
+        std::cout << "  Conversion cache:     " << stats.cacheHits << " hit(s), " << stats.cacheMisses << " miss(es)" << std::endl;
+    }
     std::cout << "  Total time:           " << std::fixed << std::setprecision(3) << duration << "s" << std::endl;
     if (!outputDir.empty()){
          std::cout << "Output(s) can be found in/under: " << outputDir.string() << std::endl;
@@ -55,4 +304,19 @@ void printProcessingSummary(int processedCount, int failedCount, double duration
     std::cout << "==================================================" << std::endl;
 }
 
+void printAllocationSummary(const std::vector<AllocationTracker::StageTotals>& stages, uint64_t totalAllocations, uint64_t totalBytes) {
+    constexpr double BYTES_PER_MB = 1024.0 * 1024.0;
+    std::cout << "\nAllocations (inclusive per stage, all threads):" << std::endl;
+    std::cout << "  " << std::left << std::setw(20) << "Stage" << std::right
+              << std::setw(10) << "Entered" << std::setw(14) << "Allocations"
+              << std::setw(14) << "Total MB" << std::setw(16) << "Peak live MB" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (const auto& stage : stages) {
+        std::cout << "  " << std::left << std::setw(20) << stage.stage << std::right
+                  << std::setw(10) << stage.activations << std::setw(14) << stage.allocations
+                  << std::setw(14) << stage.bytes / BYTES_PER_MB << std::setw(16) << stage.peakLiveBytes / BYTES_PER_MB << std::endl;
+    }
+    std::cout << "  Process total: " << totalAllocations << " allocation(s), " << totalBytes / BYTES_PER_MB << " MB" << std::endl;
+}
+
 } // namespace CLIHandler
\ No newline at end of file
@@ -4,18 +4,45 @@
 #define CLI_HANDLER_H
 
 #include "common_types.h"
+#include "utils/AllocationTracker.h"
 #include <string>
 #include <filesystem>
 
 namespace CLIHandler {
 
+    // 解析后的命令行参数
+    struct CommandLineOptions {
+        std::string inputPath;       // 单个图片或文件夹
+        std::string filesFrom;       // --files-from：路径列表文件，"-" 表示标准输入
+        bool nulSeparated = false;   // -0：列表以 NUL 分隔（配合 find -print0）
+        ShardSpec shard;             // --shard i/N
+        bool mergeShards = false;    // merge 子命令：inputPath 为批处理输出目录
+        std::string serveSocket;     // --serve：常驻服务监听的 Unix 套接字
+        bool clientMode = false;     // client 子命令：inputPath 为套接字，clientRequest 为可选的单个请求
+        std::string clientRequest;
+        std::string streamFormat;    // --to：只生成一种输出并写到标准输出（png/html/svg），inputPath 可为 "-"
+        int verbosity = 0;           // -q/--quiet 为 -1（只输出警告和错误），-v/--verbose 为 1（逐图片的详细步骤）
+        bool jsonLog = false;        // --log-format json：日志以 JSON Lines 写到标准错误
+        std::string traceFile;       // --trace：按阶段的耗时跟踪，结束时写成 Chrome Trace JSON
+        std::string reportFile;      // --report：每个输入的指标和整体吞吐量、延迟分位数（JSON）
+        bool perfCounters = false;   // --perf-counters：在报告中加入按阶段的硬件性能计数器
+        bool trackAllocations = false; // --track-allocations：按阶段和图片统计堆分配，写入汇总和报告
+        bool progress = false;       // --progress：批处理时显示进度、吞吐量和预计剩余时间
+        std::string statusFile;      // --status-file：批处理期间每秒重写的 JSON 状态文件
+        bool showHelp = false;
+    };
+
+    // 解析失败时打印原因并返回 false
+    bool parseCommandLine(int argc, char* argv[], CommandLineOptions& options);
+
     void printWelcomeMessage();
     
     // 新增：打印使用说明
     void printUsage(const std::string& programName);
 
     void printEffectiveConfiguration(const Config& config);
-    void printProcessingSummary(int processedCount, int failedCount, double duration, const std::filesystem::path& outputDir);
+    void printProcessingSummary(const ProcessingStats& stats, double duration, const std::filesystem::path& outputDir);
+    void printAllocationSummary(const std::vector<AllocationTracker::StageTotals>& stages, uint64_t totalAllocations, uint64_t totalBytes);
 
 } // namespace CLIHandler
 
@@ -0,0 +1,142 @@
+#include "AllocationTracker.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+namespace AllocationTracker {
+
+namespace {
+
+// 分配钩子里只访问这些常量初始化的线程本地变量，不会触发动态初始化或分配
+thread_local int64_t t_liveBytes = 0;
+thread_local Scope* t_innermost = nullptr;
+
+std::atomic<uint64_t> g_totalAllocations{0};
+std::atomic<uint64_t> g_totalBytes{0};
+
+// 一个线程的按阶段累计值。线程退出后仍由注册表持有
+struct ThreadTotals {
+    std::mutex mutex; // 只在 collect() 时才会有竞争
+    std::vector<StageTotals> stages;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadTotals>> threads;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+thread_local std::shared_ptr<ThreadTotals> t_totals;
+
+ThreadTotals& threadTotals() {
+    if (!t_totals) {
+        auto totals = std::make_shared<ThreadTotals>();
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.threads.push_back(totals);
+        t_totals = std::move(totals);
+    }
+    return *t_totals;
+}
+
+void mergeInto(std::vector<StageTotals>& merged, const StageTotals& totals) {
+    for (auto& existing : merged) {
+        if (existing.stage == totals.stage) {
+            existing.activations += totals.activations;
+            existing.allocations += totals.allocations;
+            existing.bytes += totals.bytes;
+            existing.peakLiveBytes = std::max(existing.peakLiveBytes, totals.peakLiveBytes);
+            return;
+        }
+    }
+    merged.push_back(totals);
+}
+
+} // end anonymous namespace
+
+void start() {
+    detail::enabled.store(true, std::memory_order_release);
+}
+
+void onAllocate(size_t size) {
+    g_totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    g_totalBytes.fetch_add(size, std::memory_order_relaxed);
+    t_liveBytes += static_cast<int64_t>(size);
+    for (Scope* scope = t_innermost; scope; scope = scope->m_parent) {
+        scope->m_allocations++;
+        scope->m_bytes += size;
+        scope->m_peakLive = std::max(scope->m_peakLive, t_liveBytes);
+    }
+}
+
+void onRelease(size_t size) {
+    t_liveBytes -= static_cast<int64_t>(size);
+}
+
+std::vector<StageTotals> collect() {
+    std::vector<std::shared_ptr<ThreadTotals>> threads;
+    {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        threads = reg.threads;
+    }
+    std::vector<StageTotals> merged;
+    for (const auto& thread : threads) {
+        std::lock_guard<std::mutex> lock(thread->mutex);
+        for (const auto& totals : thread->stages) {
+            mergeInto(merged, totals);
+        }
+    }
+    std::sort(merged.begin(), merged.end(), [](const StageTotals& a, const StageTotals& b) { return a.bytes > b.bytes; });
+    return merged;
+}
+
+void stop() {
+    detail::enabled.store(false, std::memory_order_release);
+}
+
+uint64_t getTotalAllocations() {
+    return g_totalAllocations.load(std::memory_order_relaxed);
+}
+
+uint64_t getTotalBytes() {
+    return g_totalBytes.load(std::memory_order_relaxed);
+}
+
+void Scope::begin() {
+    m_active = true;
+    m_parent = t_innermost;
+    m_startLive = t_liveBytes;
+    m_peakLive = t_liveBytes;
+    t_innermost = this;
+}
+
+void Scope::end() {
+    // 先出栈：下面登记结果时的分配只记到外层作用域
+    t_innermost = m_parent;
+
+    ThreadTotals& thread = threadTotals();
+    std::lock_guard<std::mutex> lock(thread.mutex);
+    for (auto& totals : thread.stages) {
+        if (totals.stage == m_stage) {
+            totals.activations++;
+            totals.allocations += m_allocations;
+            totals.bytes += m_bytes;
+            totals.peakLiveBytes = std::max(totals.peakLiveBytes, getPeakLiveBytes());
+            return;
+        }
+    }
+    StageTotals totals;
+    totals.stage = m_stage;
+    totals.activations = 1;
+    totals.allocations = m_allocations;
+    totals.bytes = m_bytes;
+    totals.peakLiveBytes = getPeakLiveBytes();
+    thread.stages.push_back(std::move(totals));
+}
+
+} // namespace AllocationTracker
@@ -0,0 +1,81 @@
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 按阶段的内存分配统计（--track-allocations）。
+// 分配来源有两处：可执行文件中替换的全局 operator new/delete（见 app/allocation_hooks.cpp），
+// 以及 stb 的分配钩子（BufferPool）。每次分配都记到当前线程上所有活动的 Scope（与 Trace::Span 一一对应）：
+// 字节数和次数按包含关系累计（render 包含 rasterize），峰值是作用域内线程存活字节数相对进入时的最高增量。
+// 未启用时钩子只多一次原子读取。
+namespace AllocationTracker {
+
+    struct StageTotals {
+        std::string stage;
+        uint64_t activations = 0;
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+        uint64_t peakLiveBytes = 0; // 单次进入的最大值
+    };
+
+    namespace detail {
+        inline std::atomic<bool> enabled{false};
+    }
+
+    inline bool isEnabled() {
+        return detail::enabled.load(std::memory_order_relaxed);
+    }
+
+    // 应在开始处理之前调用；之前分配、之后释放的内存会让线程存活字节数略微偏小
+    void start();
+    // 停止统计，例如基准测试只在单独的一轮中计数、计时的轮次不受钩子影响
+    void stop();
+
+    // 由分配钩子调用；size 为实际可用的字节数。不分配内存
+    void onAllocate(size_t size);
+    void onRelease(size_t size);
+
+    // 所有线程按阶段合并的累计值，以及进程内的总分配次数和字节数
+    std::vector<StageTotals> collect();
+    uint64_t getTotalAllocations();
+    uint64_t getTotalBytes();
+
+    // 一个活动的阶段。由 Trace::Span 持有，也可以单独使用
+    class Scope {
+    public:
+        explicit Scope(const char* stage) : m_stage(stage) {
+            if (isEnabled()) begin();
+        }
+        ~Scope() {
+            if (m_active) end();
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        bool active() const { return m_active; }
+        uint64_t getAllocations() const { return m_allocations; }
+        uint64_t getBytes() const { return m_bytes; }
+        uint64_t getPeakLiveBytes() const { return m_peakLive > m_startLive ? static_cast<uint64_t>(m_peakLive - m_startLive) : 0; }
+
+    private:
+        friend void onAllocate(size_t size);
+        void begin();
+        void end();
+
+        const char* m_stage;
+        bool m_active = false;
+        Scope* m_parent = nullptr;
+        int64_t m_startLive = 0;
+        int64_t m_peakLive = 0;
+        uint64_t m_allocations = 0;
+        uint64_t m_bytes = 0;
+    };
+
+} // namespace AllocationTracker
+
+#endif // ALLOCATION_TRACKER_H
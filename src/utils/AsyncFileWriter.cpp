@@ -0,0 +1,404 @@
+#include "AsyncFileWriter.h"
+#include "Logger.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <unordered_set>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define ASYNC_WRITER_HAS_IO_URING 1
+#endif
+#endif
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(ASYNC_WRITER_HAS_IO_URING)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace {
+
+#if defined(_WIN32) || defined(_WIN64)
+bool writeWholeFile(const std::filesystem::path& path, const std::vector<unsigned char>& data) {
+    std::FILE* file = _wfopen(path.wstring().c_str(), L"wb");
+    if (!file) {
+        LOG_ERROR << "Error: Failed to open file for writing: " << path.string();
+        return false;
+    }
+    bool ok = data.empty() || std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        LOG_ERROR << "Error: Failed to write to " << path.string();
+    }
+    return ok;
+}
+#else
+int openForWrite(const std::filesystem::path& path) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR << "Error: Failed to open file for writing: " << path.string() << " (" << std::strerror(errno) << ")";
+    }
+    return fd;
+}
+
+// 从 offset 开始阻塞写完剩余内容
+bool writeRemaining(int fd, const std::vector<unsigned char>& data, size_t offset) {
+    while (offset < data.size()) {
+        ssize_t written = ::pwrite(fd, data.data() + offset, data.size() - offset, static_cast<off_t>(offset));
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        offset += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool writeWholeFile(const std::filesystem::path& path, const std::vector<unsigned char>& data) {
+    int fd = openForWrite(path);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = writeRemaining(fd, data, 0);
+    ok = ::close(fd) == 0 && ok;
+    if (!ok) {
+        LOG_ERROR << "Error: Failed to write to " << path.string();
+    }
+    return ok;
+}
+#endif
+
+} // end anonymous namespace
+
+#if defined(ASYNC_WRITER_HAS_IO_URING)
+
+// 只使用最基本的接口：单次 mmap（IORING_FEAT_SINGLE_MMAP）和 IORING_OP_WRITE，要求内核 5.6 及以上
+struct AsyncFileWriter::Ring {
+    static constexpr unsigned ENTRIES = 64;
+
+    int fd = -1;
+    unsigned entries = 0;
+    void* ringPtr = MAP_FAILED;
+    size_t ringSize = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqesSize = 0;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    ~Ring() {
+        if (sqes != MAP_FAILED) munmap(sqes, sqesSize);
+        if (ringPtr != MAP_FAILED) munmap(ringPtr, ringSize);
+        if (fd >= 0) ::close(fd);
+    }
+
+    // 内核不支持、被 seccomp 禁止或版本过旧时返回 nullptr
+    static std::unique_ptr<Ring> create() {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        auto ring = std::make_unique<Ring>();
+        ring->fd = static_cast<int>(syscall(__NR_io_uring_setup, ENTRIES, &params));
+        if (ring->fd < 0) {
+            return nullptr;
+        }
+        // IORING_FEAT_RW_CUR_POS 与 IORING_OP_WRITE 同在 5.6 引入
+        if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_RW_CUR_POS)) {
+            return nullptr;
+        }
+        ring->entries = params.sq_entries;
+        ring->ringSize = std::max<size_t>(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                                          params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+        ring->ringPtr = mmap(nullptr, ring->ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+        if (ring->ringPtr == MAP_FAILED) {
+            return nullptr;
+        }
+        ring->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        ring->sqes = static_cast<io_uring_sqe*>(mmap(nullptr, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                                     ring->fd, IORING_OFF_SQES));
+        if (ring->sqes == MAP_FAILED) {
+            return nullptr;
+        }
+        char* base = static_cast<char*>(ring->ringPtr);
+        ring->sqTail = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+        ring->sqMask = reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+        ring->sqArray = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+        ring->cqHead = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+        ring->cqTail = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+        ring->cqMask = reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+        ring->cqes = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+        return ring;
+    }
+
+    // 只有 I/O 线程写 SQ 尾指针；发布给内核时需要 release 语义
+    void queueWrite(int fileFd, const unsigned char* data, unsigned length, uint64_t offset, void* userData) {
+        const unsigned tail = *sqTail;
+        const unsigned index = tail & *sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = fileFd;
+        sqe->off = offset;
+        sqe->addr = reinterpret_cast<uint64_t>(data);
+        sqe->len = length;
+        sqe->user_data = reinterpret_cast<uint64_t>(userData);
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    int enter(unsigned toSubmit, unsigned minComplete) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, IORING_ENTER_GETEVENTS, nullptr, 0));
+    }
+};
+
+#else
+
+struct AsyncFileWriter::Ring {
+    static std::unique_ptr<Ring> create() { return nullptr; }
+};
+
+#endif
+
+AsyncFileWriter::AsyncFileWriter(size_t maxInFlightBytes) : m_maxInFlightBytes(maxInFlightBytes) {
+    m_ring = Ring::create();
+    if (m_ring) {
+        m_threads.emplace_back([this] {
+            Trace::setThreadName("writer (io_uring)");
+            ringLoop();
+        });
+    } else {
+        for (size_t i = 0; i < FALLBACK_THREAD_COUNT; ++i) {
+            m_threads.emplace_back([this, i] {
+                Trace::setThreadName("writer " + std::to_string(i));
+                threadLoop();
+            });
+        }
+    }
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    drain();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_jobAvailable.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+const char* AsyncFileWriter::getBackendName() const {
+    return m_ring ? "io_uring" : "threads";
+}
+
+void AsyncFileWriter::submit(const std::filesystem::path& path, std::vector<unsigned char>&& data, Completion onComplete) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    // 单个文件超过上限时也要放行，否则会永远等待
+    auto hasSpace = [this] { return m_pendingJobs == 0 || m_inFlightBytes < m_maxInFlightBytes; };
+    if (!hasSpace()) {
+        TRACE_SPAN("write backpressure"); // 磁盘跟不上，渲染线程在此等待
+        m_spaceAvailable.wait(lock, hasSpace);
+    }
+    m_inFlightBytes += data.size();
+    m_pendingJobs++;
+    m_queue.push_back(Job{path, std::move(data), std::move(onComplete)});
+    m_jobAvailable.notify_one();
+}
+
+void AsyncFileWriter::drain() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_drained.wait(lock, [this] { return m_pendingJobs == 0; });
+}
+
+bool AsyncFileWriter::takeJob(Job& job, bool wait) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (wait) {
+        m_jobAvailable.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+    }
+    if (m_queue.empty()) {
+        return false;
+    }
+    job = std::move(m_queue.front());
+    m_queue.pop_front();
+    return true;
+}
+
+void AsyncFileWriter::complete(Job& job, bool success) {
+    if (!success) {
+        std::error_code ec;
+        std::filesystem::remove(job.path, ec); // 不留下不完整的输出
+        m_failedCount++;
+    } else {
+        m_writtenCount++;
+    }
+    if (job.onComplete) {
+        job.onComplete(success);
+    }
+    const size_t size = job.data.size();
+    std::vector<unsigned char>().swap(job.data);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_inFlightBytes -= size;
+        m_pendingJobs--;
+    }
+    m_spaceAvailable.notify_all();
+    m_drained.notify_all();
+}
+
+void AsyncFileWriter::threadLoop() {
+    Job job;
+    while (takeJob(job, true)) {
+        TRACE_SPAN_DETAIL("write", job.path.filename().string());
+        const bool ok = writeWholeFile(job.path, job.data);
+        complete(job, ok);
+    }
+}
+
+#if defined(ASYNC_WRITER_HAS_IO_URING)
+
+// 单个 I/O 线程驱动整个环：打开文件后提交写请求，收割完成事件，短写时提交剩余部分，
+// 写完后关闭文件。队列为空且没有在途请求时在条件变量上等待。
+void AsyncFileWriter::ringLoop() {
+    struct Op {
+        Job job;
+        int fd;
+        size_t offset;
+        uint64_t startNs;      // 跟踪未启用时为 0
+        bool inKernel = false; // 写请求已被内核取走、完成事件尚未收割：此时不能释放 job.data
+    };
+    constexpr size_t MAX_WRITE_CHUNK = 1u << 30;
+
+    Ring& ring = *m_ring;
+    std::unordered_set<Op*> live;
+    std::deque<Op*> unsubmitted; // 已放入提交队列但还没有被 enter 提交的请求，按入队顺序
+
+    auto queueOp = [&](Op* op) {
+        const size_t length = std::min(op->job.data.size() - op->offset, MAX_WRITE_CHUNK);
+        ring.queueWrite(op->fd, op->job.data.data() + op->offset, static_cast<unsigned>(length), op->offset, op);
+        unsubmitted.push_back(op);
+    };
+    // error 为 0 表示写入成功，否则为 errno
+    auto finishOp = [&](Op* op, int error) {
+        if (::close(op->fd) != 0 && error == 0) {
+            error = errno;
+        }
+        if (error != 0) {
+            LOG_ERROR << "Error: Failed to write to " << op->job.path.string() << " (" << std::strerror(error) << ")";
+        }
+        live.erase(op);
+        if (op->startNs != 0) {
+            // 多个写入同时在途，在时间线上作为异步区间显示
+            Trace::record("write", op->startNs, Trace::nowNs(), op->job.path.filename().string(), true);
+        }
+        complete(op->job, error == 0);
+        delete op;
+    };
+    // 收割所有已到达的完成事件；resubmit 为 false 时只记录进度，不再提交新的请求
+    auto reapCompletions = [&](bool resubmit) {
+        unsigned head = *ring.cqHead;
+        const unsigned tail = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = ring.cqes[head & *ring.cqMask];
+            Op* op = reinterpret_cast<Op*>(cqe.user_data);
+            const int result = cqe.res;
+            op->inKernel = false;
+            if (!resubmit) {
+                if (result > 0) {
+                    op->offset += static_cast<size_t>(result);
+                }
+            } else if (result == -EINTR || result == -EAGAIN) {
+                queueOp(op);
+            } else if (result <= 0) {
+                finishOp(op, result < 0 ? -result : EIO); // 没有进展的写入按 I/O 错误处理
+            } else {
+                op->offset += static_cast<size_t>(result);
+                if (op->offset < op->job.data.size()) {
+                    queueOp(op); // 短写：继续写剩余部分
+                } else {
+                    finishOp(op, 0);
+                }
+            }
+        }
+        __atomic_store_n(ring.cqHead, head, __ATOMIC_RELEASE);
+    };
+    auto anyInKernel = [&] {
+        return std::any_of(live.begin(), live.end(), [](const Op* op) { return op->inKernel; });
+    };
+
+    while (true) {
+        // 环未满时接收新任务；没有任何在途请求时阻塞等待
+        while (live.size() < ring.entries) {
+            Job job;
+            if (!takeJob(job, live.empty())) break;
+            const uint64_t startNs = Trace::isEnabled() ? Trace::nowNs() : 0;
+            int fd = openForWrite(job.path);
+            if (fd < 0) {
+                complete(job, false);
+                continue;
+            }
+            if (job.data.empty()) {
+                complete(job, ::close(fd) == 0);
+                continue;
+            }
+            Op* op = new Op{std::move(job), fd, 0, startNs};
+            live.insert(op);
+            queueOp(op);
+        }
+        if (live.empty()) {
+            return; // 正在停止且队列已空
+        }
+
+        int submitted = ring.enter(static_cast<unsigned>(unsubmitted.size()), 1);
+        if (submitted < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                continue;
+            }
+            // 环不可用：在途文件改为同步写完，之后的任务由本线程阻塞写入。
+            // 已被内核取走的请求仍可能读取 job.data，先等它们的完成事件全部到达再释放缓冲区
+            LOG_WARN << "Warning: io_uring submission failed (" << std::strerror(errno) << "); writing outputs synchronously.";
+            while (anyInKernel()) {
+                if (ring.enter(0, 1) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                    break;
+                }
+                reapCompletions(false);
+            }
+            std::vector<Op*> remaining(live.begin(), live.end());
+            for (Op* op : remaining) {
+                if (op->inKernel) {
+                    // 连等待也失败：无法确认内核已不再使用缓冲区，宁可泄漏它也不释放
+                    new std::vector<unsigned char>(std::move(op->job.data));
+                    finishOp(op, EIO);
+                    continue;
+                }
+                finishOp(op, writeRemaining(op->fd, op->job.data, op->offset) ? 0 : errno);
+            }
+            threadLoop();
+            return;
+        }
+        for (int i = 0; i < submitted && !unsubmitted.empty(); ++i) {
+            unsubmitted.front()->inKernel = true;
+            unsubmitted.pop_front();
+        }
+
+        reapCompletions(true);
+    }
+}
+
+#else
+
+void AsyncFileWriter::ringLoop() {
+    threadLoop();
+}
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef ASYNC_FILE_WRITER_H
+#define ASYNC_FILE_WRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 异步写出完整的输出文件。渲染线程把已在内存中生成的内容交给 submit() 后立即返回，
+// 由后台 I/O 线程完成打开、写入和关闭，CPU 线程不再等待磁盘。
+// Linux 上优先使用 io_uring（直接通过系统调用，不依赖 liburing），多个文件的写入同时在途；
+// 内核不支持或被禁止时退回到若干个阻塞写入的 I/O 线程。
+// 在途字节数有上限：磁盘跟不上时 submit() 阻塞，内存占用不随批次大小增长。
+class AsyncFileWriter {
+public:
+    static constexpr size_t DEFAULT_MAX_IN_FLIGHT_BYTES = 64 * 1024 * 1024;
+    static constexpr size_t FALLBACK_THREAD_COUNT = 4;
+
+    // 在 I/O 线程上调用；写入失败时不完整的文件已被删除
+    using Completion = std::function<void(bool success)>;
+
+    explicit AsyncFileWriter(size_t maxInFlightBytes = DEFAULT_MAX_IN_FLIGHT_BYTES);
+    ~AsyncFileWriter(); // 写完所有已提交的文件后退出
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    // 覆盖写入 path（父目录必须已存在）
+    void submit(const std::filesystem::path& path, std::vector<unsigned char>&& data, Completion onComplete = nullptr);
+
+    // 阻塞直到所有已提交的文件都已写完（成功或失败）
+    void drain();
+
+    // "io_uring" 或 "threads"
+    const char* getBackendName() const;
+    uint64_t getWrittenCount() const { return m_writtenCount; }
+    uint64_t getFailedCount() const { return m_failedCount; }
+
+private:
+    struct Job {
+        std::filesystem::path path;
+        std::vector<unsigned char> data;
+        Completion onComplete;
+    };
+    struct Ring; // io_uring 的映射状态，定义在 .cpp 中
+
+    // 从队列取出任务；wait 为 false 时队列为空立即返回 false，为 true 时等到有任务或停止
+    bool takeJob(Job& job, bool wait);
+    void complete(Job& job, bool success);
+    void threadLoop();
+    void ringLoop();
+
+    size_t m_maxInFlightBytes;
+    std::unique_ptr<Ring> m_ring; // nullptr 表示使用线程后备实现
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_jobAvailable;
+    std::condition_variable m_spaceAvailable;
+    std::condition_variable m_drained;
+    std::deque<Job> m_queue;
+    size_t m_inFlightBytes = 0; // 从提交到完成
+    size_t m_pendingJobs = 0;
+    bool m_stopping = false;
+
+    std::atomic<uint64_t> m_writtenCount{0};
+    std::atomic<uint64_t> m_failedCount{0};
+};
+
+#endif // ASYNC_FILE_WRITER_H
@@ -0,0 +1,70 @@
+#include "Base64.h"
+#include <array>
+
+namespace {
+
+constexpr char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+std::array<int, 256> buildDecodeTable() {
+    std::array<int, 256> table;
+    table.fill(-1);
+    for (int i = 0; i < 64; ++i) {
+        table[static_cast<unsigned char>(ALPHABET[i])] = i;
+    }
+    return table;
+}
+
+} // end anonymous namespace
+
+namespace Base64 {
+
+std::string encode(const unsigned char* data, size_t length) {
+    std::string out;
+    out.reserve((length + 2) / 3 * 4);
+    size_t i = 0;
+    for (; i + 2 < length; i += 3) {
+        unsigned int v = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        out.push_back(ALPHABET[(v >> 18) & 63]);
+        out.push_back(ALPHABET[(v >> 12) & 63]);
+        out.push_back(ALPHABET[(v >> 6) & 63]);
+        out.push_back(ALPHABET[v & 63]);
+    }
+    if (i < length) {
+        unsigned int v = data[i] << 16;
+        if (i + 1 < length) v |= data[i + 1] << 8;
+        out.push_back(ALPHABET[(v >> 18) & 63]);
+        out.push_back(ALPHABET[(v >> 12) & 63]);
+        out.push_back(i + 1 < length ? ALPHABET[(v >> 6) & 63] : '=');
+        out.push_back('=');
+    }
+    return out;
+}
+
+std::optional<std::vector<unsigned char>> decode(const std::string& text) {
+    static const std::array<int, 256> table = buildDecodeTable();
+    std::vector<unsigned char> out;
+    out.reserve(text.size() / 4 * 3);
+    unsigned int accumulator = 0;
+    int bits = 0;
+    bool padding = false;
+    for (char ch : text) {
+        if (ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t') continue;
+        if (ch == '=') {
+            padding = true;
+            continue;
+        }
+        int value = table[static_cast<unsigned char>(ch)];
+        if (value < 0 || padding) {
+            return std::nullopt;
+        }
+        accumulator = (accumulator << 6) | static_cast<unsigned int>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out.push_back(static_cast<unsigned char>((accumulator >> bits) & 0xFF));
+        }
+    }
+    return out;
+}
+
+} // namespace Base64
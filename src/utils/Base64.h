@@ -0,0 +1,18 @@
+#ifndef BASE64_H
+#define BASE64_H
+
+#include <optional>
+#include <string>
+#include <vector>
+
+// 标准 Base64（RFC 4648，带 '=' 填充），用于在 JSON 中内联传递二进制数据
+namespace Base64 {
+
+    std::string encode(const unsigned char* data, size_t length);
+
+    // 忽略空白字符；遇到非法字符时返回 nullopt
+    std::optional<std::vector<unsigned char>> decode(const std::string& text);
+
+} // namespace Base64
+
+#endif // BASE64_H
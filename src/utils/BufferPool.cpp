@@ -0,0 +1,202 @@
+#include "BufferPool.h"
+#include "AllocationTracker.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+// 比这小的块交给 malloc：它们的分配本来就很便宜，也不会产生大量缺页
+constexpr size_t MIN_POOLED_SIZE = 64 * 1024;
+// 每个线程最多缓存的字节数和每个容量级别的块数
+constexpr size_t MAX_CACHED_BYTES_PER_THREAD = 512 * 1024 * 1024;
+constexpr size_t MAX_BLOCKS_PER_CLASS = 4;
+// 达到透明大页大小的块请求使用大页（Linux THP），大画布的缺页次数减少到约 1/512
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// 放在每个块前面，记录可用容量；16 字节保证用户指针与 malloc 的对齐一致
+struct alignas(16) BlockHeader {
+    size_t capacity;
+};
+
+BlockHeader* headerOf(void* ptr) {
+    return reinterpret_cast<BlockHeader*>(static_cast<unsigned char*>(ptr) - sizeof(BlockHeader));
+}
+
+void* userPointer(BlockHeader* header) {
+    return reinterpret_cast<unsigned char*>(header) + sizeof(BlockHeader);
+}
+
+// 容量级别：每个 2 的幂区间再分为 4 级
+size_t roundToClass(size_t size) {
+    size_t power = MIN_POOLED_SIZE;
+    while (power < size / 2) {
+        power *= 2;
+    }
+    const size_t step = power / 4;
+    return (size + step - 1) / step * step;
+}
+
+void adviseHugePages(void* start, size_t length) {
+#if defined(MADV_HUGEPAGE)
+    // madvise 要求页对齐：只对块内部按大页对齐的部分生效
+    const uintptr_t begin = (reinterpret_cast<uintptr_t>(start) + HUGE_PAGE_SIZE - 1) & ~(uintptr_t(HUGE_PAGE_SIZE) - 1);
+    const uintptr_t end = (reinterpret_cast<uintptr_t>(start) + length) & ~(uintptr_t(HUGE_PAGE_SIZE) - 1);
+    if (end > begin) {
+        madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE);
+    }
+#else
+    (void)start;
+    (void)length;
+#endif
+}
+
+struct ThreadCache {
+    std::unordered_map<size_t, std::vector<BlockHeader*>> freeBlocks; // 按容量
+    size_t cachedBytes = 0;
+
+    ~ThreadCache();
+};
+
+// 线程退出时缓存先于其他线程本地对象析构，之后的释放直接交给 free
+thread_local bool t_cacheDestroyed = false;
+thread_local ThreadCache t_cache;
+
+// 本线程持有的块容量之和；在其他线程释放的块会让它偏小，因此按有符号数记录
+thread_local int64_t t_liveBytes = 0;
+thread_local int64_t t_peakBytes = 0;
+thread_local int64_t t_peakBase = 0;
+
+void* handOut(BlockHeader* header) {
+    // 复用缓存块也算一次分配：对阶段而言它和新分配的内存一样
+    if (AllocationTracker::isEnabled()) {
+        AllocationTracker::onAllocate(header->capacity);
+    }
+    t_liveBytes += static_cast<int64_t>(header->capacity);
+    if (t_liveBytes > t_peakBytes) {
+        t_peakBytes = t_liveBytes;
+    }
+    return userPointer(header);
+}
+
+ThreadCache::~ThreadCache() {
+    for (auto& entry : freeBlocks) {
+        for (BlockHeader* header : entry.second) {
+            std::free(header);
+        }
+    }
+    t_cacheDestroyed = true;
+}
+
+} // end anonymous namespace
+
+namespace BufferPool {
+
+void* allocate(size_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+    size_t capacity = size;
+    if (size >= MIN_POOLED_SIZE) {
+        capacity = roundToClass(size);
+        if (!t_cacheDestroyed) {
+            auto it = t_cache.freeBlocks.find(capacity);
+            if (it != t_cache.freeBlocks.end() && !it->second.empty()) {
+                BlockHeader* header = it->second.back();
+                it->second.pop_back();
+                t_cache.cachedBytes -= capacity;
+                return handOut(header);
+            }
+        }
+    }
+    if (capacity > SIZE_MAX - sizeof(BlockHeader)) {
+        return nullptr;
+    }
+    auto* header = static_cast<BlockHeader*>(std::malloc(sizeof(BlockHeader) + capacity));
+    if (!header) {
+        return nullptr;
+    }
+    header->capacity = capacity;
+    if (capacity >= HUGE_PAGE_SIZE) {
+        adviseHugePages(userPointer(header), capacity);
+    }
+    return handOut(header);
+}
+
+void* reallocate(void* ptr, size_t newSize) {
+    if (!ptr) {
+        return allocate(newSize);
+    }
+    BlockHeader* header = headerOf(ptr);
+    if (newSize <= header->capacity) {
+        return ptr;
+    }
+    void* grown = allocate(newSize);
+    if (!grown) {
+        return nullptr; // 与 realloc 一致：原块保持有效
+    }
+    std::memcpy(grown, ptr, header->capacity);
+    release(ptr);
+    return grown;
+}
+
+void release(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    BlockHeader* header = headerOf(ptr);
+    const size_t capacity = header->capacity;
+    if (AllocationTracker::isEnabled()) {
+        AllocationTracker::onRelease(capacity);
+    }
+    t_liveBytes -= static_cast<int64_t>(capacity);
+    if (capacity < MIN_POOLED_SIZE || t_cacheDestroyed
+        || t_cache.cachedBytes + capacity > MAX_CACHED_BYTES_PER_THREAD) {
+        std::free(header);
+        return;
+    }
+    std::vector<BlockHeader*>& blocks = t_cache.freeBlocks[capacity];
+    if (blocks.size() >= MAX_BLOCKS_PER_CLASS) {
+        std::free(header);
+        return;
+    }
+    blocks.push_back(header);
+    t_cache.cachedBytes += capacity;
+}
+
+void resetThreadPeak() {
+    t_peakBase = t_liveBytes;
+    t_peakBytes = t_liveBytes;
+}
+
+size_t getThreadPeakSinceReset() {
+    return t_peakBytes > t_peakBase ? static_cast<size_t>(t_peakBytes - t_peakBase) : 0;
+}
+
+Buffer::Buffer(Buffer&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)) {}
+
+Buffer& Buffer::operator=(Buffer&& other) noexcept {
+    if (this != &other) {
+        release(m_data);
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+    return *this;
+}
+
+bool Buffer::resize(size_t size) {
+    release(m_data);
+    m_data = static_cast<unsigned char*>(allocate(size));
+    m_size = m_data ? size : 0;
+    return m_data != nullptr;
+}
+
+} // namespace BufferPool
@@ -0,0 +1,49 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <cstddef>
+
+// 大块缓冲区的线程本地复用池。每个工作线程缓存自己释放的大块（按容量分级，每级相差不超过 25%），
+// 下一张图片申请相近大小时直接复用已经触碰过的页，避免反复向系统申请并产生缺页。
+// stb 的 STBI_MALLOC / STBIW_MALLOC / STBTT_malloc 都指向这里（见 stb_impl.cpp），
+// 解码出的 RGB 数据、PNG 编码的中间缓冲和渲染画布因此都会在线程内复用。
+// 可以在任意线程释放；块进入释放线程的缓存。小块直接交给 malloc。
+namespace BufferPool {
+
+    // 与 malloc 相同的对齐保证；失败时返回 nullptr
+    void* allocate(size_t size);
+    // ptr 为 nullptr 时等同于 allocate；新大小不超过块的容量时原地返回
+    void* reallocate(void* ptr, size_t newSize);
+    void release(void* ptr);
+
+    // 当前线程经由缓冲池持有的字节数（解码结果、编码中间缓冲、画布）在 resetThreadPeak() 之后的最高增量，
+    // 用作单张图片的内存占用估计（--report）
+    void resetThreadPeak();
+    size_t getThreadPeakSinceReset();
+
+    // 画布等大缓冲的 RAII 包装。resize() 不保留也不初始化内容。
+    class Buffer {
+    public:
+        Buffer() = default;
+        ~Buffer() { release(m_data); }
+
+        Buffer(Buffer&& other) noexcept;
+        Buffer& operator=(Buffer&& other) noexcept;
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+
+        // 内存不足时返回 false，缓冲区变为空
+        bool resize(size_t size);
+
+        unsigned char* data() { return m_data; }
+        const unsigned char* data() const { return m_data; }
+        size_t size() const { return m_size; }
+
+    private:
+        unsigned char* m_data = nullptr;
+        size_t m_size = 0;
+    };
+
+} // namespace BufferPool
+
+#endif // BUFFER_POOL_H
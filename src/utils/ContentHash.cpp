@@ -0,0 +1,157 @@
+#include "ContentHash.h"
+#include "Logger.h"
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+constexpr size_t FILE_READ_CHUNK = 1 << 20;
+
+inline uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t read64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i]; // 小端读取，与平台无关
+    return v;
+}
+
+inline uint32_t read32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline uint64_t round(uint64_t acc, uint64_t input) {
+    acc += input * PRIME2;
+    acc = rotl(acc, 31);
+    return acc * PRIME1;
+}
+
+inline uint64_t mergeRound(uint64_t acc, uint64_t val) {
+    acc ^= round(0, val);
+    return acc * PRIME1 + PRIME4;
+}
+
+} // end anonymous namespace
+
+namespace ContentHash {
+
+Hasher::Hasher(uint64_t seed) : m_seed(seed) {
+    m_acc[0] = seed + PRIME1 + PRIME2;
+    m_acc[1] = seed + PRIME2;
+    m_acc[2] = seed;
+    m_acc[3] = seed - PRIME1;
+}
+
+void Hasher::update(const void* data, size_t length) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + length;
+    m_totalLength += length;
+
+    if (m_bufferSize + length < sizeof(m_buffer)) {
+        if (length > 0) std::memcpy(m_buffer + m_bufferSize, p, length);
+        m_bufferSize += length;
+        return;
+    }
+
+    if (m_bufferSize > 0) {
+        size_t fill = sizeof(m_buffer) - m_bufferSize;
+        std::memcpy(m_buffer + m_bufferSize, p, fill);
+        p += fill;
+        for (int i = 0; i < 4; ++i) m_acc[i] = round(m_acc[i], read64(m_buffer + i * 8));
+        m_bufferSize = 0;
+    }
+
+    while (end - p >= 32) {
+        m_acc[0] = round(m_acc[0], read64(p));
+        m_acc[1] = round(m_acc[1], read64(p + 8));
+        m_acc[2] = round(m_acc[2], read64(p + 16));
+        m_acc[3] = round(m_acc[3], read64(p + 24));
+        p += 32;
+    }
+
+    m_bufferSize = static_cast<size_t>(end - p);
+    if (m_bufferSize > 0) std::memcpy(m_buffer, p, m_bufferSize);
+}
+
+uint64_t Hasher::digest() const {
+    uint64_t h;
+    if (m_totalLength >= 32) {
+        h = rotl(m_acc[0], 1) + rotl(m_acc[1], 7) + rotl(m_acc[2], 12) + rotl(m_acc[3], 18);
+        for (int i = 0; i < 4; ++i) h = mergeRound(h, m_acc[i]);
+    } else {
+        h = m_seed + PRIME5;
+    }
+    h += m_totalLength;
+
+    const unsigned char* p = m_buffer;
+    const unsigned char* end = m_buffer + m_bufferSize;
+    while (end - p >= 8) {
+        h ^= round(0, read64(p));
+        h = rotl(h, 27) * PRIME1 + PRIME4;
+        p += 8;
+    }
+    if (end - p >= 4) {
+        h ^= static_cast<uint64_t>(read32(p)) * PRIME1;
+        h = rotl(h, 23) * PRIME2 + PRIME3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= (*p) * PRIME5;
+        h = rotl(h, 11) * PRIME1;
+        ++p;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t hashBytes(const void* data, size_t length, uint64_t seed) {
+    Hasher hasher(seed);
+    hasher.update(data, length);
+    return hasher.digest();
+}
+
+std::optional<uint64_t> hashFile(const std::filesystem::path& filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file) {
+        LOG_ERROR << "Error: Cannot open file for hashing '" << filePath.string() << "'";
+        return std::nullopt;
+    }
+    Hasher hasher;
+    std::vector<char> chunk(FILE_READ_CHUNK);
+    while (file) {
+        file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        std::streamsize got = file.gcount();
+        if (got > 0) hasher.update(chunk.data(), static_cast<size_t>(got));
+    }
+    if (file.bad()) {
+        LOG_ERROR << "Error: Failed while reading file for hashing '" << filePath.string() << "'";
+        return std::nullopt;
+    }
+    return hasher.digest();
+}
+
+std::string toHex(uint64_t hash) {
+    static const char digits[] = "0123456789abcdef";
+    std::string out(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        out[static_cast<size_t>(i)] = digits[hash & 0xF];
+        hash >>= 4;
+    }
+    return out;
+}
+
+} // namespace ContentHash
@@ -0,0 +1,38 @@
+#ifndef CONTENT_HASH_H
+#define CONTENT_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+// 快速的非加密 64 位内容哈希（XXH64 算法），用于识别源文件内容。
+namespace ContentHash {
+
+    // 增量式哈希器：分块 update() 的结果与一次性 hashBytes() 完全一致
+    class Hasher {
+    public:
+        explicit Hasher(uint64_t seed = 0);
+        void update(const void* data, size_t length);
+        uint64_t digest() const;
+
+    private:
+        uint64_t m_acc[4];
+        unsigned char m_buffer[32];
+        size_t m_bufferSize = 0;
+        uint64_t m_totalLength = 0;
+        uint64_t m_seed;
+    };
+
+    uint64_t hashBytes(const void* data, size_t length, uint64_t seed = 0);
+
+    // 流式读取整个文件并计算哈希；无法读取时返回 nullopt
+    std::optional<uint64_t> hashFile(const std::filesystem::path& filePath);
+
+    // 固定 16 位小写十六进制表示
+    std::string toHex(uint64_t hash);
+
+} // namespace ContentHash
+
+#endif // CONTENT_HASH_H
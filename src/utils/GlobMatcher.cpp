@@ -0,0 +1,61 @@
+#include "GlobMatcher.h"
+
+namespace {
+
+bool matchFrom(const std::string& pattern, size_t p, const std::string& text, size_t t) {
+    while (p < pattern.size()) {
+        char c = pattern[p];
+        if (c == '*') {
+            if (p + 1 < pattern.size() && pattern[p + 1] == '*') {
+                size_t rest = p + 2;
+                if (rest < pattern.size() && pattern[rest] == '/') {
+                    // "**/"：在当前位置或任意 '/' 之后继续匹配
+                    for (size_t i = t; i <= text.size(); ++i) {
+                        if ((i == t || text[i - 1] == '/') && matchFrom(pattern, rest + 1, text, i)) return true;
+                    }
+                    return false;
+                }
+                for (size_t i = t; i <= text.size(); ++i) {
+                    if (matchFrom(pattern, rest, text, i)) return true;
+                }
+                return false;
+            }
+            for (size_t i = t; i <= text.size(); ++i) {
+                if (matchFrom(pattern, p + 1, text, i)) return true;
+                if (i < text.size() && text[i] == '/') return false;
+            }
+            return false;
+        }
+        if (t >= text.size()) return false;
+        if (c == '?') {
+            if (text[t] == '/') return false;
+        } else if (c != text[t]) {
+            return false;
+        }
+        ++p;
+        ++t;
+    }
+    return t == text.size();
+}
+
+} // end anonymous namespace
+
+namespace GlobMatcher {
+
+bool matches(const std::string& pattern, const std::string& relativePath) {
+    if (pattern.find('/') == std::string::npos) {
+        size_t slash = relativePath.rfind('/');
+        std::string name = (slash == std::string::npos) ? relativePath : relativePath.substr(slash + 1);
+        return matchFrom(pattern, 0, name, 0);
+    }
+    return matchFrom(pattern, 0, relativePath, 0);
+}
+
+bool matchesAny(const std::vector<std::string>& patterns, const std::string& relativePath) {
+    for (const auto& pattern : patterns) {
+        if (matches(pattern, relativePath)) return true;
+    }
+    return false;
+}
+
+} // namespace GlobMatcher
@@ -0,0 +1,20 @@
+#ifndef GLOB_MATCHER_H
+#define GLOB_MATCHER_H
+
+#include <string>
+#include <vector>
+
+// 简单的路径通配符匹配（区分大小写，路径分隔符统一为 '/'）：
+//   *   匹配除 '/' 以外的任意字符序列
+//   ?   匹配除 '/' 以外的单个字符
+//   **  匹配任意字符序列（可跨目录）；"**/" 也可匹配零层目录
+// 不含 '/' 的模式只与最后一级名称（文件名或目录名）比较，含 '/' 的模式与完整相对路径比较。
+namespace GlobMatcher {
+
+    bool matches(const std::string& pattern, const std::string& relativePath);
+
+    bool matchesAny(const std::vector<std::string>& patterns, const std::string& relativePath);
+
+} // namespace GlobMatcher
+
+#endif // GLOB_MATCHER_H
@@ -0,0 +1,372 @@
+#include "Logger.h"
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+namespace Log {
+
+namespace {
+
+struct Record {
+    std::atomic<Record*> next{nullptr};
+    Level level = Level::Info;
+    unsigned thread = 0;
+    int64_t timeMs = 0;
+    bool status = false; // setStatusLine：text 为新的状态行
+    std::string text;
+};
+
+// 多生产者单消费者的无锁队列（Vyukov）：push 只有一次原子交换，pop 只由写线程调用
+class RecordQueue {
+public:
+    RecordQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+    ~RecordQueue() {
+        while (Record* record = pop()) delete record;
+    }
+
+    void push(Record* record) {
+        record->next.store(nullptr, std::memory_order_relaxed);
+        Record* previous = m_head.exchange(record, std::memory_order_acq_rel);
+        previous->next.store(record, std::memory_order_release);
+    }
+
+    // 队列为空（或生产者正处于 push 的两步之间）时返回 nullptr
+    Record* pop() {
+        Record* tail = m_tail;
+        Record* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &m_stub) {
+            if (!next) return nullptr;
+            m_tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            m_tail = next;
+            return tail;
+        }
+        if (tail != m_head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        // 只剩最后一条：放回占位节点，让它与 tail 断开
+        push(&m_stub);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            m_tail = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+private:
+    std::atomic<Record*> m_head;
+    Record* m_tail;
+    Record m_stub;
+};
+
+const char* levelName(Level level) {
+    switch (level) {
+        case Level::Error: return "error";
+        case Level::Warning: return "warning";
+        case Level::Info: return "info";
+        case Level::Debug: return "debug";
+    }
+    return "info";
+}
+
+// 去掉文本格式中用于排版的首尾换行，以及与 level 字段重复的 "Error: " 等前缀
+std::string plainMessage(const std::string& text) {
+    size_t begin = text.find_first_not_of('\n');
+    if (begin == std::string::npos) return std::string();
+    size_t end = text.find_last_not_of('\n') + 1;
+    for (const char* prefix : {"Error: ", "Warning: ", "Info: "}) {
+        const size_t length = std::char_traits<char>::length(prefix);
+        if (text.compare(begin, length, prefix) == 0) {
+            begin += length;
+            break;
+        }
+    }
+    return text.substr(begin, end - begin);
+}
+
+struct Logger {
+    // start() 之前只输出警告和错误：作为库嵌入时不向宿主程序的标准输出打印进度信息
+    std::atomic<int> level{static_cast<int>(Level::Warning)};
+    Format format = Format::Text;
+    bool allToStderr = false;
+
+    RecordQueue queue;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> submitted{0};
+    uint64_t written = 0;      // 由写线程更新，受 mutex 保护
+    std::atomic<bool> writerSleeping{false};
+    bool stopping = false;
+    std::thread writer;
+    std::string statusLine;    // 只由写线程访问
+    bool statusShown = false;
+
+    std::mutex mutex;          // 保护 written/stopping、选项，以及同步写出
+    std::condition_variable wake;
+    std::condition_variable flushed;
+
+    std::FILE* targetFor(Level l) const {
+        return (allToStderr || format == Format::Json || l <= Level::Warning) ? stderr : stdout;
+    }
+
+    void appendFormatted(std::string& out, const Record& record) const {
+        if (format == Format::Json) {
+            char timestamp[32];
+            std::snprintf(timestamp, sizeof(timestamp), "%.3f", record.timeMs / 1000.0);
+            out += "{\"ts\":";
+            out += timestamp;
+            out += ",\"level\":\"";
+            out += levelName(record.level);
+            out += "\",\"thread\":";
+            out += std::to_string(record.thread);
+            out += ",\"msg\":";
+            // 路径可能不是合法的 UTF-8，替换而不是抛出异常
+            out += nlohmann::json(plainMessage(record.text)).dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+            out += "}\n";
+        } else {
+            out += record.text;
+            out += '\n';
+        }
+    }
+
+    void writeSync(const Record& record) {
+        std::string line;
+        std::lock_guard<std::mutex> lock(mutex);
+        appendFormatted(line, record);
+        std::FILE* target = targetFor(record.level);
+        std::fwrite(line.data(), 1, line.size(), target);
+        std::fflush(target);
+    }
+
+    // 状态行画在标准错误的最后一行，光标留在行尾；清除时回到行首并擦除整行
+    void clearStatusLine() {
+        if (statusShown) {
+            std::fputs("\r\x1b[K", stderr);
+            std::fflush(stderr);
+            statusShown = false;
+        }
+    }
+
+    void drawStatusLine() {
+        clearStatusLine();
+        if (!statusLine.empty()) {
+            std::fwrite(statusLine.data(), 1, statusLine.size(), stderr);
+            std::fflush(stderr);
+            statusShown = true;
+        }
+    }
+
+    // 写线程：一次取空队列，按目标流合并后写出，每轮结束时 flush。
+    // 有状态行时先擦掉它再写日志，本轮写完后重绘
+    void writerLoop() {
+        std::string pending;
+        std::FILE* pendingTarget = nullptr;
+        auto emit = [&] {
+            if (pendingTarget && !pending.empty()) {
+                std::fwrite(pending.data(), 1, pending.size(), pendingTarget);
+                std::fflush(pendingTarget);
+            }
+            pending.clear();
+        };
+        while (true) {
+            uint64_t count = 0;
+            bool redraw = false;
+            while (Record* record = queue.pop()) {
+                count++;
+                if (record->status) {
+                    statusLine = std::move(record->text);
+                    redraw = true;
+                    delete record;
+                    continue;
+                }
+                if (statusShown) {
+                    emit();
+                    clearStatusLine();
+                    redraw = true;
+                }
+                std::FILE* target = targetFor(record->level);
+                if (target != pendingTarget) {
+                    emit(); // 切换目标流前先写出，保持两个流之间的先后顺序
+                    pendingTarget = target;
+                }
+                appendFormatted(pending, *record);
+                delete record;
+            }
+            emit();
+            if (redraw) {
+                drawStatusLine();
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+            written += count;
+            flushed.notify_all();
+            if (count > 0) continue;
+            if (stopping && written == submitted.load()) {
+                clearStatusLine();
+                return;
+            }
+            // 生产者只在写线程睡眠时才通知；限时等待兜底 push 与睡眠之间的竞争
+            writerSleeping = true;
+            wake.wait_for(lock, std::chrono::milliseconds(20));
+            writerSleeping = false;
+        }
+    }
+};
+
+Logger& logger() {
+    static Logger instance;
+    return instance;
+}
+
+unsigned currentThreadIndex() {
+    static std::atomic<unsigned> nextIndex{0};
+    thread_local unsigned index = nextIndex++;
+    return index;
+}
+
+// 每个线程复用一个格式化缓冲；格式状态在每条日志开始时复位
+struct ThreadBuffer {
+    std::ostringstream stream;
+    std::ostringstream pristine;
+    bool inUse = false;
+};
+
+ThreadBuffer& threadBuffer() {
+    thread_local ThreadBuffer buffer;
+    return buffer;
+}
+
+thread_local std::string t_firstError;
+thread_local bool t_hasError = false;
+
+} // end anonymous namespace
+
+void start(const Options& options) {
+    Logger& log = logger();
+    {
+        std::lock_guard<std::mutex> lock(log.mutex);
+        log.format = options.format;
+        log.allToStderr = options.allToStderr;
+        log.level = static_cast<int>(options.level);
+        if (log.running) return;
+        log.stopping = false;
+        log.running = true;
+    }
+    log.writer = std::thread(&Logger::writerLoop, &log);
+    static bool registered = false;
+    if (!registered) {
+        registered = true;
+        std::atexit(stop); // 经由 exit() 结束时也不丢失排队的日志
+    }
+}
+
+void flush() {
+    Logger& log = logger();
+    if (!log.running) return;
+    std::unique_lock<std::mutex> lock(log.mutex);
+    const uint64_t target = log.submitted.load();
+    log.wake.notify_one();
+    log.flushed.wait(lock, [&] { return log.written >= target; });
+}
+
+void stop() {
+    Logger& log = logger();
+    {
+        std::lock_guard<std::mutex> lock(log.mutex);
+        if (!log.running) return;
+        log.stopping = true;
+    }
+    log.wake.notify_one();
+    log.writer.join();
+    log.running = false;
+}
+
+bool isEnabled(Level level) {
+    return static_cast<int>(level) <= logger().level.load(std::memory_order_relaxed);
+}
+
+void clearThreadError() {
+    t_firstError.clear();
+    t_hasError = false;
+}
+
+std::string getThreadError() {
+    return t_firstError;
+}
+
+void write(Level level, std::string message) {
+    if (level == Level::Error && !t_hasError) {
+        t_hasError = true;
+        const size_t begin = message.find_first_not_of(" \n");
+        t_firstError = begin == std::string::npos ? std::string() : plainMessage(message.substr(begin));
+    }
+    Logger& log = logger();
+    auto* record = new Record;
+    record->level = level;
+    record->thread = currentThreadIndex();
+    record->timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    record->text = std::move(message);
+
+    if (!log.running.load(std::memory_order_acquire)) {
+        log.writeSync(*record);
+        delete record;
+        return;
+    }
+    log.submitted.fetch_add(1);
+    log.queue.push(record);
+    if (log.writerSleeping.load(std::memory_order_relaxed)) {
+        log.wake.notify_one();
+    }
+}
+
+void setStatusLine(std::string line) {
+    Logger& log = logger();
+    if (!log.running.load(std::memory_order_acquire)) {
+        return;
+    }
+    auto* record = new Record;
+    record->status = true;
+    record->text = std::move(line);
+    log.submitted.fetch_add(1);
+    log.queue.push(record);
+    if (log.writerSleeping.load(std::memory_order_relaxed)) {
+        log.wake.notify_one();
+    }
+}
+
+Line::Line(Level level) : m_level(level) {
+    ThreadBuffer& buffer = threadBuffer();
+    if (buffer.inUse) {
+        // 参数表达式里又记录了日志：使用独立的缓冲
+        m_nested = std::make_unique<std::ostringstream>();
+        m_stream = m_nested.get();
+        return;
+    }
+    buffer.inUse = true;
+    buffer.stream.str(std::string());
+    buffer.stream.clear();
+    buffer.stream.copyfmt(buffer.pristine);
+    m_stream = &buffer.stream;
+}
+
+Line::~Line() {
+    std::string text = m_stream->str();
+    if (!m_nested) {
+        threadBuffer().inUse = false;
+    }
+    // 调用方在行尾保留的 std::endl 不重复换行
+    while (!text.empty() && text.back() == '\n') {
+        text.pop_back();
+    }
+    write(m_level, std::move(text));
+}
+
+} // namespace Log
@@ -0,0 +1,76 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <sstream>
+#include <memory>
+#include <string>
+
+// 进程内日志。每条日志先在线程本地缓冲中格式化成完整的一行，再压入无锁队列，
+// 由单个写线程批量写出：并发任务的输出不会交错，工作线程也不再为每行 flush 控制台而等待。
+// start() 之前（例如作为库嵌入时）日志同步写出，且只输出 Warning 及以上级别。
+// 文本格式下 Info/Debug 写到标准输出、Warning/Error 写到标准错误，与原来的 cout/cerr 一致；
+// JSON Lines 格式下每条日志一行 JSON，全部写到标准错误。
+namespace Log {
+
+    enum class Level { Error = 0, Warning = 1, Info = 2, Debug = 3 };
+    enum class Format { Text, Json };
+
+    struct Options {
+        Level level = Level::Info;   // 高于此级别的日志被丢弃（--quiet 为 Warning，-v 为 Debug）
+        Format format = Format::Text;
+        bool allToStderr = false;    // 标准输出留给数据时（--to）
+    };
+
+    // 启动后台写线程；再次调用只更新选项
+    void start(const Options& options);
+    // 阻塞直到此前提交的日志都已写出；在向控制台直接打印其他内容之前调用
+    void flush();
+    // 写完剩余日志并停止写线程，之后恢复同步写出
+    void stop();
+
+    // 终端最后一行的状态行（--progress），写到标准错误：写线程写日志前先擦掉它、写完后重绘，
+    // 两者不会交错。空字符串清除状态行；stop() 时也会清除。写线程未运行时忽略
+    void setStatusLine(std::string line);
+
+    bool isEnabled(Level level);
+    void write(Level level, std::string message);
+
+    // 当前线程自上次 clearThreadError() 以来的第一条错误（不含 "Error: " 前缀），
+    // 用于在报告中给出单张图片的失败原因；没有错误时为空
+    void clearThreadError();
+    std::string getThreadError();
+
+    // 一条日志，析构时整条提交。通过下面的 LOG_* 宏使用，级别未开启时右侧的表达式不会求值。
+    class Line {
+    public:
+        explicit Line(Level level);
+        ~Line();
+
+        Line(const Line&) = delete;
+        Line& operator=(const Line&) = delete;
+
+        template <typename T>
+        Line& operator<<(const T& value) {
+            *m_stream << value;
+            return *this;
+        }
+        Line& operator<<(std::ostream& (*manipulator)(std::ostream&)) {
+            *m_stream << manipulator;
+            return *this;
+        }
+
+    private:
+        Level m_level;
+        std::ostringstream* m_stream;                 // 线程本地缓冲，嵌套使用时为 m_nested
+        std::unique_ptr<std::ostringstream> m_nested;
+    };
+
+} // namespace Log
+
+#define LOG_AT(level) if (!Log::isEnabled(level)) {} else Log::Line(level)
+#define LOG_ERROR LOG_AT(Log::Level::Error)
+#define LOG_WARN  LOG_AT(Log::Level::Warning)
+#define LOG_INFO  LOG_AT(Log::Level::Info)
+#define LOG_DEBUG LOG_AT(Log::Level::Debug)
+
+#endif // LOGGER_H
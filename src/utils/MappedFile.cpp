@@ -0,0 +1,140 @@
+#include "MappedFile.h"
+#include "Logger.h"
+#include <utility>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_isOpen = std::exchange(other.m_isOpen, false);
+#if defined(_WIN32) || defined(_WIN64)
+        m_fileHandle = std::exchange(other.m_fileHandle, nullptr);
+        m_mappingHandle = std::exchange(other.m_mappingHandle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+
+bool MappedFile::open(const std::filesystem::path& filePath, Access access) {
+    close();
+    HANDLE file = CreateFileW(filePath.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        LOG_ERROR << "Error: Cannot open file for mapping '" << filePath.string() << "'";
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        LOG_ERROR << "Error: Cannot query size of '" << filePath.string() << "'";
+        CloseHandle(file);
+        return false;
+    }
+    m_fileHandle = file;
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+    m_isOpen = true;
+    if (m_size == 0) {
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        LOG_ERROR << "Error: Cannot create file mapping for '" << filePath.string() << "'";
+        close();
+        return false;
+    }
+    m_mappingHandle = mapping;
+    m_data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr) {
+        LOG_ERROR << "Error: Cannot map view of '" << filePath.string() << "'";
+        close();
+        return false;
+    }
+    advise(access);
+    return true;
+}
+
+void MappedFile::advise(Access) const {
+    // Windows 上由系统自行预读
+}
+
+void MappedFile::close() {
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mappingHandle) CloseHandle(static_cast<HANDLE>(m_mappingHandle));
+    if (m_fileHandle) CloseHandle(static_cast<HANDLE>(m_fileHandle));
+    m_data = nullptr;
+    m_mappingHandle = nullptr;
+    m_fileHandle = nullptr;
+    m_size = 0;
+    m_isOpen = false;
+}
+
+#else
+
+bool MappedFile::open(const std::filesystem::path& filePath, Access access) {
+    close();
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG_ERROR << "Error: Cannot open file for mapping '" << filePath.string() << "'";
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        LOG_ERROR << "Error: Cannot query size of '" << filePath.string() << "'";
+        ::close(fd);
+        return false;
+    }
+    m_size = static_cast<size_t>(st.st_size);
+    if (m_size > 0) {
+        void* addr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            LOG_ERROR << "Error: Cannot map file '" << filePath.string() << "'";
+            ::close(fd);
+            m_size = 0;
+            return false;
+        }
+        m_data = static_cast<const unsigned char*>(addr);
+    }
+    ::close(fd); // 映射建立后即可关闭描述符
+    m_isOpen = true;
+    advise(access);
+    return true;
+}
+
+void MappedFile::advise(Access access) const {
+    if (!m_data || m_size == 0 || access == Access::Normal) return;
+    void* addr = const_cast<unsigned char*>(m_data);
+    if (access == Access::Sequential) {
+        madvise(addr, m_size, MADV_SEQUENTIAL);
+    }
+    // 顺序读取的输入也会被立即从头读到尾，两种方式都提前触发预读
+    madvise(addr, m_size, MADV_WILLNEED);
+}
+
+void MappedFile::close() {
+    if (m_data) munmap(const_cast<unsigned char*>(m_data), m_size);
+    m_data = nullptr;
+    m_size = 0;
+    m_isOpen = false;
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <filesystem>
+
+// 只读内存映射文件。映射在对象析构时释放，不可复制，可移动。
+// 映射是只读的，可以在多个线程间共享读取。
+class MappedFile {
+public:
+    // 访问方式提示，传给 madvise；不支持的平台上忽略
+    enum class Access {
+        Normal,
+        Sequential, // 从头到尾读一遍（解码、哈希）：加大预读，读过的页可尽早回收
+        WillNeed    // 马上会用到全部内容（字体）：立即开始预读
+    };
+
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // 映射整个文件。成功返回 true；空文件也视为成功（data() 为 nullptr，size() 为 0）。
+    bool open(const std::filesystem::path& filePath, Access access = Access::Normal);
+    void close();
+    void advise(Access access) const;
+
+    bool isOpen() const { return m_isOpen; }
+    const unsigned char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_isOpen = false;
+#if defined(_WIN32) || defined(_WIN64)
+    void* m_fileHandle = nullptr;
+    void* m_mappingHandle = nullptr;
+#endif
+};
+
+#endif // MAPPED_FILE_H
@@ -1,5 +1,5 @@
 #include "PathManager.h"
-#include <iostream>
+#include "Logger.h"
 #include <system_error> // For std::error_code
 
 #if defined(_WIN32) || defined(_WIN64)
@@ -41,7 +41,7 @@ std::filesystem::path getExecutablePath(int argc, char* argv[]) {
             #endif
         }
     } catch (const std::exception& e) {
-        std::cerr << "Warning: Exception resolving executable path: " << e.what() << ". Using fallback." << std::endl;
+        LOG_WARN << "Warning: Exception resolving executable path: " << e.what() << ". Using fallback.";
         std::string fallbackName = "ascii_generator_fallback";
         #ifdef _WIN32
             fallbackName += ".exe";
@@ -55,16 +55,34 @@ std::filesystem::path setupOutputDirectory(const std::filesystem::path& baseDir,
     std::filesystem::path outputDirPath = baseDir / dirName;
     try {
         if (std::filesystem::create_directories(outputDirPath)) {
-             std::cout << "Created output directory: " << outputDirPath.string() << std::endl;
+             LOG_DEBUG << "Created output directory: " << outputDirPath.string();
         } else if (!std::filesystem::exists(outputDirPath) || !std::filesystem::is_directory(outputDirPath)) {
-             std::cerr << "Error: Failed to create or access output directory: " << outputDirPath.string() << std::endl;
+             LOG_ERROR << "Error: Failed to create or access output directory: " << outputDirPath.string();
              return std::filesystem::path();
         }
         return outputDirPath;
     } catch (const std::filesystem::filesystem_error& e) {
-        std::cerr << "Error (filesystem): Creating directory " << outputDirPath.string() << ": " << e.what() << std::endl;
+        LOG_ERROR << "Error (filesystem): Creating directory " << outputDirPath.string() << ": " << e.what();
         return std::filesystem::path();
     }
 }
 
+bool linkOrCopyFile(const std::filesystem::path& source, const std::filesystem::path& target) {
+    std::error_code ec;
+    if (std::filesystem::equivalent(source, target, ec)) {
+        return true; // 已经是同一个文件（例如上一次运行留下的硬链接）
+    }
+    std::filesystem::remove(target, ec);
+    std::filesystem::create_hard_link(source, target, ec);
+    if (!ec) {
+        return true;
+    }
+    std::filesystem::copy_file(source, target, std::filesystem::copy_options::overwrite_existing, ec);
+    if (ec) {
+        LOG_ERROR << "Error: Failed to link or copy " << source.string() << " to " << target.string() << ": " << ec.message();
+        return false;
+    }
+    return true;
+}
+
 } // namespace PathManager
\ No newline at end of file
@@ -7,6 +7,8 @@
 namespace PathManager {
     std::filesystem::path getExecutablePath(int argc, char* argv[]);
     std::filesystem::path setupOutputDirectory(const std::filesystem::path& baseDir, const std::string& dirName);
+    // 将 target 指向 source 的内容：优先创建硬链接，失败（跨文件系统等）时复制。已存在的 target 会被替换。
+    bool linkOrCopyFile(const std::filesystem::path& source, const std::filesystem::path& target);
 }
 
 #endif // PATH_MANAGER_H
\ No newline at end of file
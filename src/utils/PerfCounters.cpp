@@ -0,0 +1,249 @@
+#include "PerfCounters.h"
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <fstream>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define PERF_COUNTERS_SUPPORTED 1
+#endif
+
+namespace PerfCounters {
+
+namespace {
+
+// 一个线程的累计值。线程退出后仍由注册表持有，collect() 时读取
+struct ThreadTotals {
+    std::mutex mutex; // 只在 collect() 时才会有竞争
+    std::vector<StageTotals> stages;
+
+    void add(const char* stage, const std::array<uint64_t, COUNTER_COUNT>& values, const std::array<bool, COUNTER_COUNT>& available) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& totals : stages) {
+            if (totals.stage == stage) {
+                totals.samples++;
+                for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+                    totals.values[i] += values[i];
+                }
+                return;
+            }
+        }
+        StageTotals totals;
+        totals.stage = stage;
+        totals.samples = 1;
+        totals.values = values;
+        totals.available = available;
+        stages.push_back(std::move(totals));
+    }
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadTotals>> threads;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+#if defined(PERF_COUNTERS_SUPPORTED)
+
+constexpr uint64_t EVENT_CONFIGS[COUNTER_COUNT] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+int openEvent(uint64_t config, int groupFd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.exclude_kernel = 1; // perf_event_paranoid 为 2 时也允许只统计用户态
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, PERF_FLAG_FD_CLOEXEC));
+}
+
+std::string describeError(int error) {
+    if (error == EACCES || error == EPERM) {
+        std::string paranoid;
+        std::ifstream file("/proc/sys/kernel/perf_event_paranoid");
+        if (file >> paranoid) {
+            return "permission denied (kernel.perf_event_paranoid = " + paranoid + ")";
+        }
+        return "permission denied";
+    }
+    if (error == ENOENT || error == EOPNOTSUPP || error == ENODEV) {
+        return "hardware counters are not exposed (virtual machine or container)";
+    }
+    if (error == ENOSYS) {
+        return "perf_event_open is not available in this kernel";
+    }
+    return std::strerror(error);
+}
+
+// 当前线程的计数器组：第一个能打开的事件作为组长，其余事件加入同一组，一次 read 读出全部
+struct CounterGroup {
+    int leader = -1;
+    int fds[COUNTER_COUNT] = {-1, -1, -1, -1};
+    int slot[COUNTER_COUNT] = {-1, -1, -1, -1}; // 事件在 read 结果中的位置
+    int memberCount = 0;
+    int openError = 0;
+    std::array<bool, COUNTER_COUNT> available{};
+    std::shared_ptr<ThreadTotals> totals;
+
+    bool open() {
+        for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+            int fd = openEvent(EVENT_CONFIGS[i], leader);
+            if (fd < 0) {
+                if (openError == 0) openError = errno;
+                continue;
+            }
+            fds[i] = fd;
+            slot[i] = memberCount++;
+            available[i] = true;
+            if (leader < 0) leader = fd;
+        }
+        return leader >= 0;
+    }
+
+    ~CounterGroup() {
+        for (int fd : fds) {
+            if (fd >= 0) ::close(fd);
+        }
+    }
+
+    bool read(uint64_t& timeEnabled, uint64_t& timeRunning, std::array<uint64_t, COUNTER_COUNT>& values) const {
+        uint64_t buffer[3 + COUNTER_COUNT];
+        const ssize_t expected = static_cast<ssize_t>((3 + memberCount) * sizeof(uint64_t));
+        if (::read(leader, buffer, sizeof(buffer)) < expected || buffer[0] != static_cast<uint64_t>(memberCount)) {
+            return false;
+        }
+        timeEnabled = buffer[1];
+        timeRunning = buffer[2];
+        for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+            values[i] = slot[i] >= 0 ? buffer[3 + slot[i]] : 0;
+        }
+        return true;
+    }
+};
+
+// 打开失败的线程记为 nullptr，之后不再重试
+thread_local bool t_attempted = false;
+thread_local std::unique_ptr<CounterGroup> t_group;
+
+CounterGroup* threadGroup() {
+    if (!t_attempted) {
+        t_attempted = true;
+        auto group = std::make_unique<CounterGroup>();
+        if (group->open()) {
+            group->totals = std::make_shared<ThreadTotals>();
+            Registry& reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.threads.push_back(group->totals);
+            t_group = std::move(group);
+        }
+    }
+    return t_group.get();
+}
+
+#endif
+
+} // end anonymous namespace
+
+bool start(std::string& reason) {
+#if defined(PERF_COUNTERS_SUPPORTED)
+    CounterGroup probe;
+    if (!probe.open()) {
+        reason = describeError(probe.openError);
+        return false;
+    }
+    uint64_t enabled = 0;
+    uint64_t running = 0;
+    std::array<uint64_t, COUNTER_COUNT> values{};
+    if (!probe.read(enabled, running, values)) {
+        reason = "counters could not be read";
+        return false;
+    }
+    detail::enabled.store(true, std::memory_order_release);
+    return true;
+#else
+    reason = "not supported on this platform";
+    return false;
+#endif
+}
+
+std::vector<StageTotals> collect() {
+    std::vector<std::shared_ptr<ThreadTotals>> threads;
+    {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        threads = reg.threads;
+    }
+    std::vector<StageTotals> merged;
+    for (const auto& thread : threads) {
+        std::lock_guard<std::mutex> lock(thread->mutex);
+        for (const auto& totals : thread->stages) {
+            StageTotals* target = nullptr;
+            for (auto& existing : merged) {
+                if (existing.stage == totals.stage) {
+                    target = &existing;
+                    break;
+                }
+            }
+            if (!target) {
+                merged.push_back(totals);
+                continue;
+            }
+            target->samples += totals.samples;
+            for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+                target->values[i] += totals.values[i];
+                target->available[i] = target->available[i] && totals.available[i];
+            }
+        }
+    }
+    return merged;
+}
+
+void Scope::begin() {
+#if defined(PERF_COUNTERS_SUPPORTED)
+    CounterGroup* group = threadGroup();
+    if (group && group->read(m_start.timeEnabled, m_start.timeRunning, m_start.values)) {
+        m_thread = group;
+    }
+#endif
+}
+
+void Scope::end() {
+#if defined(PERF_COUNTERS_SUPPORTED)
+    const CounterGroup* group = static_cast<const CounterGroup*>(m_thread);
+    Snapshot now;
+    if (!group->read(now.timeEnabled, now.timeRunning, now.values)) {
+        return;
+    }
+    const uint64_t enabledDelta = now.timeEnabled - m_start.timeEnabled;
+    const uint64_t runningDelta = now.timeRunning - m_start.timeRunning;
+    if (runningDelta == 0) {
+        return; // 这段时间内计数器组一直没有被调度到 PMU 上
+    }
+    std::array<uint64_t, COUNTER_COUNT> deltas{};
+    for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+        const uint64_t delta = now.values[i] - m_start.values[i];
+        // 被复用轮换时按比例换算成整段时间的估计值
+        deltas[i] = runningDelta < enabledDelta
+            ? static_cast<uint64_t>(static_cast<long double>(delta) * enabledDelta / runningDelta)
+            : delta;
+    }
+    group->totals->add(m_stage, deltas, group->available);
+#endif
+}
+
+} // namespace PerfCounters
@@ -0,0 +1,74 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 按阶段的硬件性能计数器（--perf-counters）：周期、指令、缓存未命中和分支预测失败。
+// 每个线程打开自己的一组 perf_event_open 计数器（只统计用户态），在阶段开始和结束时各读取一次，
+// 差值按阶段累加；计数器被内核轮换复用时按启用/运行时间比例换算。
+// 容器或虚拟机中常常无法使用：start() 返回 false 并给出原因，之后 Scope 都是空操作。
+// 仅支持 Linux。
+namespace PerfCounters {
+
+    enum Counter { CYCLES = 0, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, COUNTER_COUNT };
+
+    struct StageTotals {
+        std::string stage;
+        uint64_t samples = 0;
+        std::array<uint64_t, COUNTER_COUNT> values{};
+        std::array<bool, COUNTER_COUNT> available{}; // 内核不支持的事件为 false
+    };
+
+    namespace detail {
+        inline std::atomic<bool> enabled{false};
+    }
+
+    inline bool isEnabled() {
+        return detail::enabled.load(std::memory_order_relaxed);
+    }
+
+    // 在调用线程上试探性地打开计数器；失败时 reason 给出原因，采集保持关闭
+    bool start(std::string& reason);
+
+    // 所有线程（包括已退出的）按阶段合并后的累计值
+    std::vector<StageTotals> collect();
+
+    // 作用域内的一个阶段；stage 必须是字符串字面量
+    class Scope {
+    public:
+        explicit Scope(const char* stage) : m_stage(stage) {
+            if (isEnabled()) begin();
+        }
+        ~Scope() {
+            if (m_thread) end();
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        struct Snapshot {
+            uint64_t timeEnabled = 0;
+            uint64_t timeRunning = 0;
+            std::array<uint64_t, COUNTER_COUNT> values{};
+        };
+
+        void begin();
+        void end();
+
+        const char* m_stage;
+        void* m_thread = nullptr; // 本线程的计数器组；未启用或不可用时为 nullptr
+        Snapshot m_start;
+    };
+
+} // namespace PerfCounters
+
+#define PERF_CONCAT_INNER(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_INNER(a, b)
+#define PERF_SCOPE(stage) PerfCounters::Scope PERF_CONCAT(perfScope_, __LINE__)(stage)
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,300 @@
+#include "TarReader.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <fcntl.h>
+#endif
+
+namespace {
+
+constexpr size_t BLOCK_SIZE = 512;
+// readData 每次增长缓冲区的上限：声明的大小不可信（管道输入无法事先校验）
+constexpr size_t READ_CHUNK_SIZE = 16 * 1024 * 1024;
+
+// ustar 头中各字段的偏移和长度
+constexpr size_t NAME_OFFSET = 0, NAME_LEN = 100;
+constexpr size_t SIZE_OFFSET = 124, SIZE_LEN = 12;
+constexpr size_t MTIME_OFFSET = 136, MTIME_LEN = 12;
+constexpr size_t CHKSUM_OFFSET = 148, CHKSUM_LEN = 8;
+constexpr size_t TYPE_OFFSET = 156;
+constexpr size_t MAGIC_OFFSET = 257;
+constexpr size_t PREFIX_OFFSET = 345, PREFIX_LEN = 155;
+
+std::string readField(const unsigned char* block, size_t offset, size_t length) {
+    const char* start = reinterpret_cast<const char*>(block + offset);
+    return std::string(start, strnlen(start, length));
+}
+
+// 数值字段：八进制文本，或 GNU 扩展的 base-256（首字节最高位为 1）
+std::optional<int64_t> parseNumber(const unsigned char* field, size_t length) {
+    if (field[0] & 0x80) {
+        const bool negative = (field[0] & 0x40) != 0;
+        uint64_t value = negative ? ~uint64_t{0} : 0;
+        value = (value << 6) | (field[0] & 0x3f);
+        for (size_t i = 1; i < length; ++i) {
+            value = (value << 8) | field[i];
+        }
+        return static_cast<int64_t>(value);
+    }
+    size_t i = 0;
+    while (i < length && (field[i] == ' ' || field[i] == '\0')) ++i;
+    int64_t value = 0;
+    bool any = false;
+    for (; i < length && field[i] >= '0' && field[i] <= '7'; ++i) {
+        value = (value << 3) | (field[i] - '0');
+        any = true;
+    }
+    if (i < length && field[i] != ' ' && field[i] != '\0') return std::nullopt;
+    if (!any) return 0;
+    return value;
+}
+
+bool isZeroBlock(const unsigned char* block) {
+    return std::all_of(block, block + BLOCK_SIZE, [](unsigned char c) { return c == 0; });
+}
+
+bool checksumMatches(const unsigned char* block) {
+    auto stored = parseNumber(block + CHKSUM_OFFSET, CHKSUM_LEN);
+    if (!stored) return false;
+    // 校验和按校验字段填满空格计算；早期实现按有符号字节求和，两种都接受
+    int64_t unsignedSum = 0, signedSum = 0;
+    for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+        const bool inChecksum = i >= CHKSUM_OFFSET && i < CHKSUM_OFFSET + CHKSUM_LEN;
+        const unsigned char c = inChecksum ? ' ' : block[i];
+        unsignedSum += c;
+        signedSum += static_cast<signed char>(c);
+    }
+    return *stored == unsignedSum || *stored == signedSum;
+}
+
+std::string stripTrailingNuls(std::string text) {
+    while (!text.empty() && text.back() == '\0') text.pop_back();
+    return text;
+}
+
+// pax 扩展头中的覆盖值
+struct PaxOverrides {
+    std::optional<std::string> path;
+    std::optional<uint64_t> size;
+    std::optional<int64_t> mtime;
+};
+
+// 记录格式："<长度> <键>=<值>\n"，长度包含整条记录
+bool parsePaxRecords(const std::string& records, PaxOverrides& overrides) {
+    size_t pos = 0;
+    while (pos < records.size()) {
+        if (records[pos] == '\0') break;
+        const size_t space = records.find(' ', pos);
+        if (space == std::string::npos) return false;
+        size_t recordLength = 0;
+        try {
+            recordLength = std::stoul(records.substr(pos, space - pos));
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (recordLength == 0 || pos + recordLength > records.size() || records[pos + recordLength - 1] != '\n') return false;
+        const std::string record = records.substr(space + 1, pos + recordLength - space - 2);
+        pos += recordLength;
+
+        const size_t equals = record.find('=');
+        if (equals == std::string::npos) continue;
+        const std::string key = record.substr(0, equals);
+        const std::string value = record.substr(equals + 1);
+        try {
+            if (key == "path") {
+                overrides.path = value;
+            } else if (key == "size") {
+                overrides.size = std::stoull(value);
+            } else if (key == "mtime") {
+                overrides.mtime = static_cast<int64_t>(std::stod(value));
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // end anonymous namespace
+
+TarReader::~TarReader() {
+    if (m_file) {
+        std::fclose(m_file);
+    }
+}
+
+bool TarReader::open(const std::filesystem::path& archivePath) {
+    m_path = archivePath;
+#if defined(_WIN32) || defined(_WIN64)
+    m_file = _wfopen(archivePath.wstring().c_str(), L"rb");
+#else
+    m_file = std::fopen(archivePath.string().c_str(), "rb");
+#endif
+    if (!m_file) {
+        return fail("Cannot open archive");
+    }
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(archivePath, ec)) {
+        const uintmax_t fileSize = std::filesystem::file_size(archivePath, ec);
+        if (!ec) {
+            m_archiveSize = fileSize;
+        }
+    }
+    // 大块顺序读取：归档中的小文件不再各自产生一次打开和若干次小读取
+    m_buffer.resize(READ_BUFFER_SIZE);
+    std::setvbuf(m_file, m_buffer.data(), _IOFBF, m_buffer.size());
+#if defined(POSIX_FADV_SEQUENTIAL)
+    // 归档从头到尾只读一遍，让内核加大预读窗口
+    posix_fadvise(fileno(m_file), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    return true;
+}
+
+bool TarReader::fail(const std::string& message) {
+    LOG_ERROR << "Error: " << message << ": " << m_path.string();
+    m_error = true;
+    return false;
+}
+
+uint64_t TarReader::remainingBytes() {
+    if (m_archiveSize == UINT64_MAX) return UINT64_MAX;
+#if defined(_WIN32) || defined(_WIN64)
+    const int64_t position = _ftelli64(m_file);
+#else
+    const int64_t position = static_cast<int64_t>(ftello(m_file));
+#endif
+    if (position < 0) return UINT64_MAX;
+    return static_cast<uint64_t>(position) >= m_archiveSize ? 0 : m_archiveSize - static_cast<uint64_t>(position);
+}
+
+bool TarReader::readBlock(unsigned char* block) {
+    return std::fread(block, 1, BLOCK_SIZE, m_file) == BLOCK_SIZE;
+}
+
+bool TarReader::skipBytes(uint64_t count) {
+    if (count == 0) return true;
+#if defined(_WIN32) || defined(_WIN64)
+    if (_fseeki64(m_file, static_cast<__int64>(count), SEEK_CUR) == 0) return true;
+#else
+    if (fseeko(m_file, static_cast<off_t>(count), SEEK_CUR) == 0) return true;
+#endif
+    // 不可定位的输入（管道）：读取后丢弃
+    char scratch[64 * 1024];
+    while (count > 0) {
+        const size_t chunk = static_cast<size_t>(std::min<uint64_t>(count, sizeof(scratch)));
+        if (std::fread(scratch, 1, chunk, m_file) != chunk) return false;
+        count -= chunk;
+    }
+    return true;
+}
+
+bool TarReader::readBytes(std::string& out, uint64_t count) {
+    if (count > MAX_EXTENDED_HEADER_BYTES || count > remainingBytes()) return false;
+    out.resize(static_cast<size_t>(count));
+    if (count > 0 && std::fread(&out[0], 1, out.size(), m_file) != out.size()) return false;
+    return skipBytes((BLOCK_SIZE - count % BLOCK_SIZE) % BLOCK_SIZE);
+}
+
+bool TarReader::nextEntry(TarEntry& entry) {
+    if (!m_file || m_error) return false;
+    if (!skipBytes(m_pendingData + m_pendingPadding)) {
+        return fail("Truncated archive");
+    }
+    m_pendingData = 0;
+    m_pendingPadding = 0;
+
+    PaxOverrides pax;
+    std::optional<std::string> longName;
+    unsigned char block[BLOCK_SIZE];
+    while (true) {
+        if (!readBlock(block)) {
+            // 没有结尾的两个全零块也按结束处理，但不完整的块说明归档被截断
+            if (std::feof(m_file) && !std::ferror(m_file)) return false;
+            return fail("Failed to read archive");
+        }
+        if (isZeroBlock(block)) {
+            return false; // 归档结束标记
+        }
+        if (!checksumMatches(block)) {
+            return fail("Invalid tar header checksum");
+        }
+
+        auto size = parseNumber(block + SIZE_OFFSET, SIZE_LEN);
+        auto mtime = parseNumber(block + MTIME_OFFSET, MTIME_LEN);
+        if (!size || *size < 0 || !mtime) {
+            return fail("Invalid tar header");
+        }
+        const char type = static_cast<char>(block[TYPE_OFFSET]);
+
+        // --- 作用于下一个条目的扩展头 ---
+        if (type == 'L' || type == 'x' || type == 'K' || type == 'g') {
+            std::string payload;
+            if (static_cast<uint64_t>(*size) > MAX_EXTENDED_HEADER_BYTES) {
+                return fail("Extended tar header is too large");
+            }
+            if (!readBytes(payload, static_cast<uint64_t>(*size))) {
+                return fail("Truncated archive");
+            }
+            if (type == 'L') {
+                longName = stripTrailingNuls(payload);
+            } else if (type == 'x' && !parsePaxRecords(payload, pax)) {
+                return fail("Invalid pax extended header");
+            }
+            continue; // 'K'（长链接名）和 'g'（全局 pax 头）不影响图片条目
+        }
+
+        entry.type = type;
+        entry.size = pax.size ? *pax.size : static_cast<uint64_t>(*size);
+        entry.mtime = pax.mtime ? *pax.mtime : *mtime;
+        if (pax.path) {
+            entry.path = *pax.path;
+        } else if (longName) {
+            entry.path = *longName;
+        } else {
+            entry.path = readField(block, NAME_OFFSET, NAME_LEN);
+            const bool isUstar = std::memcmp(block + MAGIC_OFFSET, "ustar", 5) == 0;
+            const std::string prefix = isUstar ? readField(block, PREFIX_OFFSET, PREFIX_LEN) : std::string();
+            if (!prefix.empty()) {
+                entry.path = prefix + "/" + entry.path;
+            }
+        }
+
+        // 链接、设备、目录和 FIFO 条目不跟随数据，即使 size 字段非零
+        const bool hasData = std::strchr("123456", type) == nullptr || type == '\0';
+        m_pendingData = hasData ? entry.size : 0;
+        m_pendingPadding = (BLOCK_SIZE - m_pendingData % BLOCK_SIZE) % BLOCK_SIZE;
+        if (m_pendingData > remainingBytes()) {
+            m_pendingData = 0;
+            m_pendingPadding = 0;
+            return fail("Tar entry '" + entry.path + "' claims more data than the archive contains");
+        }
+        return true;
+    }
+}
+
+bool TarReader::readData(std::vector<unsigned char>& data) {
+    data.clear();
+    if (m_pendingData > SIZE_MAX) {
+        return fail("Tar entry is too large");
+    }
+    // 普通文件归档中的大小已在 nextEntry() 中与剩余长度核对过，可以一次预留；
+    // 管道输入按块增长：截断或大小字段损坏的归档在读到末尾时失败，而不是先分配声明的大小
+    if (m_archiveSize != UINT64_MAX) {
+        data.reserve(static_cast<size_t>(m_pendingData));
+    }
+    while (m_pendingData > 0) {
+        const size_t chunk = static_cast<size_t>(std::min<uint64_t>(m_pendingData, READ_CHUNK_SIZE));
+        const size_t offset = data.size();
+        data.resize(offset + chunk);
+        if (std::fread(data.data() + offset, 1, chunk, m_file) != chunk) {
+            data.clear();
+            m_pendingData = 0;
+            return fail("Truncated archive");
+        }
+        m_pendingData -= chunk;
+    }
+    return true;
+}
@@ -0,0 +1,63 @@
+#ifndef TAR_READER_H
+#define TAR_READER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// tar 条目头信息。path 已合并 ustar 前缀、GNU 长文件名（'L'）和 pax 扩展头（'x' 中的 path/size/mtime）。
+struct TarEntry {
+    std::string path;
+    char type = '0';    // '0' 或 '\0' 为普通文件，'5' 为目录，其余类型调用方通常跳过
+    uint64_t size = 0;
+    int64_t mtime = 0;  // 秒
+
+    bool isRegularFile() const { return type == '0' || type == '\0' || type == '7'; }
+};
+
+// 顺序读取 tar 归档（ustar / GNU / pax）。整个归档通过一个带大缓冲的读取流顺序读取，
+// 不需要的条目内容直接跳过。不可复制。
+// 头部中的大小字段不可信：扩展头有长度上限，普通文件归档中超出剩余长度的条目视为损坏，
+// 条目内容按块读取，缓冲区随实际读到的数据增长，不会按声明的大小一次性分配。
+class TarReader {
+public:
+    static constexpr size_t READ_BUFFER_SIZE = 4 * 1024 * 1024;
+    // 'L'/'K' 长文件名和 pax 扩展头内容的上限
+    static constexpr uint64_t MAX_EXTENDED_HEADER_BYTES = 1024 * 1024;
+
+    TarReader() = default;
+    ~TarReader();
+
+    TarReader(const TarReader&) = delete;
+    TarReader& operator=(const TarReader&) = delete;
+
+    bool open(const std::filesystem::path& archivePath);
+
+    // 读取下一个条目的头。上一个条目的内容若未读取则自动跳过。
+    // 到达归档末尾或出错时返回 false，出错时 hasError() 为 true。
+    bool nextEntry(TarEntry& entry);
+    // 读取当前条目的全部内容（每个条目只能调用一次）
+    bool readData(std::vector<unsigned char>& data);
+
+    bool hasError() const { return m_error; }
+
+private:
+    bool readBlock(unsigned char* block);
+    bool skipBytes(uint64_t count);
+    bool readBytes(std::string& out, uint64_t count);
+    // 当前位置之后还剩多少字节；输入不是普通文件（管道等）时返回 UINT64_MAX
+    uint64_t remainingBytes();
+    bool fail(const std::string& message);
+
+    std::filesystem::path m_path;
+    std::FILE* m_file = nullptr;
+    std::vector<char> m_buffer;
+    uint64_t m_archiveSize = UINT64_MAX; // 普通文件的长度，未知时为 UINT64_MAX
+    uint64_t m_pendingData = 0;    // 当前条目尚未读取的内容字节数
+    uint64_t m_pendingPadding = 0; // 内容之后补齐到 512 字节的填充
+    bool m_error = false;
+};
+
+#endif // TAR_READER_H
@@ -0,0 +1,132 @@
+#include "TarWriter.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr size_t BLOCK_SIZE = 512;
+constexpr size_t NAME_LEN = 100;
+
+// 以八进制写入数值字段（末尾保留 NUL）
+void putOctal(unsigned char* field, size_t length, uint64_t value) {
+    std::memset(field, '0', length - 1);
+    field[length - 1] = '\0';
+    for (size_t i = length - 1; i-- > 0 && value > 0;) {
+        field[i] = static_cast<unsigned char>('0' + (value & 7));
+        value >>= 3;
+    }
+}
+
+void putString(unsigned char* field, size_t length, const std::string& text) {
+    std::memcpy(field, text.data(), std::min(length, text.size()));
+}
+
+// pax 记录 "<长度> <键>=<值>\n"，长度包含自身的十进制位数
+std::string makePaxRecord(const std::string& key, const std::string& value) {
+    const size_t payload = 1 + key.size() + 1 + value.size() + 1; // ' ' key '=' value '\n'
+    size_t length = payload + 1;
+    while (std::to_string(length).size() + payload != length) {
+        length = std::to_string(length).size() + payload;
+    }
+    return std::to_string(length) + " " + key + "=" + value + "\n";
+}
+
+// 条目名超长时 ustar 头里只放截断后的名字，完整路径由之前的 pax 头提供
+std::string truncatedName(const std::string& name) {
+    return name.size() <= NAME_LEN ? name : name.substr(name.size() - NAME_LEN);
+}
+
+} // end anonymous namespace
+
+TarWriter::~TarWriter() {
+    if (m_file) {
+        std::fclose(m_file);
+    }
+}
+
+bool TarWriter::open(const std::filesystem::path& archivePath) {
+    m_path = archivePath;
+#if defined(_WIN32) || defined(_WIN64)
+    m_file = _wfopen(archivePath.wstring().c_str(), L"wb");
+#else
+    m_file = std::fopen(archivePath.string().c_str(), "wb");
+#endif
+    if (!m_file) {
+        LOG_ERROR << "Error: Failed to open archive for writing: " << m_path.string();
+        return false;
+    }
+    // 条目通常只有几十 KB，合并成大块顺序写入
+    m_buffer.resize(WRITE_BUFFER_SIZE);
+    std::setvbuf(m_file, m_buffer.data(), _IOFBF, m_buffer.size());
+    return true;
+}
+
+bool TarWriter::writeBytes(const void* data, size_t size) {
+    if (m_failed || !m_file) return false;
+    if (size > 0 && std::fwrite(data, 1, size, m_file) != size) {
+        LOG_ERROR << "Error: Failed to write archive: " << m_path.string();
+        m_failed = true;
+    }
+    return !m_failed;
+}
+
+bool TarWriter::writePadding(uint64_t size) {
+    static const unsigned char zeros[BLOCK_SIZE] = {};
+    const size_t padding = static_cast<size_t>((BLOCK_SIZE - size % BLOCK_SIZE) % BLOCK_SIZE);
+    return writeBytes(zeros, padding);
+}
+
+bool TarWriter::writeHeader(const std::string& name, char type, uint64_t size, int64_t mtime, const std::string& linkName) {
+    if (name.size() > NAME_LEN || linkName.size() > NAME_LEN) {
+        std::string records;
+        if (name.size() > NAME_LEN) records += makePaxRecord("path", name);
+        if (linkName.size() > NAME_LEN) records += makePaxRecord("linkpath", linkName);
+        if (!writeHeader("././@PaxHeader", 'x', records.size(), mtime, std::string())
+            || !writeBytes(records.data(), records.size()) || !writePadding(records.size())) {
+            return false;
+        }
+    }
+
+    unsigned char header[BLOCK_SIZE] = {};
+    putString(header + 0, NAME_LEN, truncatedName(name));
+    putOctal(header + 100, 8, 0644);                              // mode
+    putOctal(header + 108, 8, 0);                                 // uid
+    putOctal(header + 116, 8, 0);                                 // gid
+    putOctal(header + 124, 12, size);                             // size
+    putOctal(header + 136, 12, static_cast<uint64_t>(mtime > 0 ? mtime : 0));
+    header[156] = static_cast<unsigned char>(type);
+    putString(header + 157, NAME_LEN, truncatedName(linkName));
+    std::memcpy(header + 257, "ustar", 6);                        // magic（含 NUL）
+    std::memcpy(header + 263, "00", 2);                           // version
+
+    // 校验和按校验字段填满空格计算
+    std::memset(header + 148, ' ', 8);
+    unsigned int checksum = 0;
+    for (unsigned char c : header) checksum += c;
+    putOctal(header + 148, 7, checksum);
+    header[155] = ' ';
+
+    return writeBytes(header, sizeof(header));
+}
+
+bool TarWriter::addFile(const std::string& name, const unsigned char* data, size_t size, int64_t mtime) {
+    return writeHeader(name, '0', size, mtime, std::string()) && writeBytes(data, size) && writePadding(size);
+}
+
+bool TarWriter::addHardLink(const std::string& name, const std::string& target, int64_t mtime) {
+    return writeHeader(name, '1', 0, mtime, target);
+}
+
+bool TarWriter::close() {
+    if (!m_file) return false;
+    static const unsigned char zeros[BLOCK_SIZE * 2] = {};
+    writeBytes(zeros, sizeof(zeros));
+    std::FILE* file = m_file;
+    m_file = nullptr;
+    if (std::fclose(file) != 0 && !m_failed) {
+        LOG_ERROR << "Error: Failed to finish writing archive: " << m_path.string();
+        m_failed = true;
+    }
+    return !m_failed;
+}
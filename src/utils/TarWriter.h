@@ -0,0 +1,44 @@
+#ifndef TAR_WRITER_H
+#define TAR_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// 顺序写出 POSIX ustar 归档。超过 100 字节的条目名使用 pax 扩展头（'x'）记录完整路径。
+// 不可复制；不是线程安全的，由单个写线程使用。
+class TarWriter {
+public:
+    static constexpr size_t WRITE_BUFFER_SIZE = 4 * 1024 * 1024;
+
+    TarWriter() = default;
+    ~TarWriter();
+
+    TarWriter(const TarWriter&) = delete;
+    TarWriter& operator=(const TarWriter&) = delete;
+
+    bool open(const std::filesystem::path& archivePath);
+    // name 使用 '/' 分隔的相对路径
+    bool addFile(const std::string& name, const unsigned char* data, size_t size, int64_t mtime);
+    // 硬链接条目：解包时 name 指向归档中已有的 target
+    bool addHardLink(const std::string& name, const std::string& target, int64_t mtime);
+    // 写入结尾的两个全零块并关闭文件
+    bool close();
+
+    bool isOpen() const { return m_file != nullptr; }
+
+private:
+    bool writeHeader(const std::string& name, char type, uint64_t size, int64_t mtime, const std::string& linkName);
+    bool writeBytes(const void* data, size_t size);
+    bool writePadding(uint64_t size);
+
+    std::filesystem::path m_path;
+    std::FILE* m_file = nullptr;
+    std::vector<char> m_buffer;
+    bool m_failed = false;
+};
+
+#endif // TAR_WRITER_H
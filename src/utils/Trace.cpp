@@ -0,0 +1,189 @@
+#include "Trace.h"
+#include "Logger.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Trace {
+
+namespace {
+
+struct Event {
+    const char* name = nullptr;
+    uint64_t startNs = 0;
+    uint64_t endNs = 0;
+    std::string detail; // 槽位复用时保留容量
+    bool async = false;
+};
+
+// 一个线程的环形缓冲区。锁只在导出时才会有竞争
+struct ThreadBuffer {
+    std::mutex mutex;
+    std::vector<Event> events;
+    size_t next = 0;
+    uint64_t recorded = 0;
+    unsigned tid = 0;
+    std::string name;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers; // 线程退出后仍保留，导出时使用
+    size_t eventsPerThread = DEFAULT_EVENTS_PER_THREAD;
+    uint64_t startNs = 0;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+thread_local std::string t_threadName;
+thread_local std::shared_ptr<ThreadBuffer> t_buffer;
+
+ThreadBuffer& threadBuffer() {
+    if (!t_buffer) {
+        Registry& reg = registry();
+        auto buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        buffer->events.resize(reg.eventsPerThread);
+        buffer->tid = static_cast<unsigned>(reg.buffers.size()) + 1;
+        buffer->name = t_threadName.empty() ? "thread " + std::to_string(buffer->tid) : t_threadName;
+        reg.buffers.push_back(buffer);
+        t_buffer = std::move(buffer);
+    }
+    return *t_buffer;
+}
+
+// Trace Event 的时间单位是微秒
+double toMicros(uint64_t ns, uint64_t originNs) {
+    return ns >= originNs ? (ns - originNs) / 1000.0 : 0.0;
+}
+
+} // end anonymous namespace
+
+void StageTimes::add(const char* name, uint64_t ns) {
+    for (auto& entry : totalsNs) {
+        // 同名的字面量在不同编译单元中不一定是同一个地址
+        if (entry.first == name || std::strcmp(entry.first, name) == 0) {
+            entry.second += ns;
+            return;
+        }
+    }
+    totalsNs.emplace_back(name, ns);
+}
+
+void start(size_t eventsPerThread) {
+    Registry& reg = registry();
+    {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.eventsPerThread = std::max<size_t>(1, eventsPerThread);
+        reg.startNs = nowNs();
+    }
+    detail::enabled.store(true, std::memory_order_release);
+}
+
+uint64_t nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void setThreadName(const std::string& name) {
+    t_threadName = name;
+    if (t_buffer) {
+        std::lock_guard<std::mutex> lock(t_buffer->mutex);
+        t_buffer->name = name;
+    }
+}
+
+void record(const char* name, uint64_t startNs, uint64_t endNs, std::string detail, bool async) {
+    if (!isEnabled()) {
+        return;
+    }
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    Event& event = buffer.events[buffer.next];
+    event.name = name;
+    event.startNs = startNs;
+    event.endNs = std::max(startNs, endNs);
+    event.detail.assign(detail);
+    event.async = async;
+    buffer.next = (buffer.next + 1) % buffer.events.size();
+    buffer.recorded++;
+}
+
+bool writeChromeTrace(const std::filesystem::path& outputPath) {
+    Registry& reg = registry();
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    uint64_t originNs = 0;
+    {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        buffers = reg.buffers;
+        originNs = reg.startNs;
+    }
+
+    std::ofstream out(outputPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        LOG_ERROR << "Error: Cannot create trace file " << outputPath.string();
+        return false;
+    }
+
+    // 一行一个事件，大批次的跟踪文件也能逐步写出
+    uint64_t eventCount = 0;
+    uint64_t droppedCount = 0;
+    uint64_t asyncId = 0;
+    bool first = true;
+    auto emit = [&](const nlohmann::json& event) {
+        out << (first ? "\n" : ",\n") << event.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+        first = false;
+    };
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    emit({{"name", "process_name"}, {"ph", "M"}, {"pid", 1}, {"tid", 0}, {"args", {{"name", "ascii_generator"}}}});
+    for (const auto& buffer : buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        emit({{"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", buffer->tid}, {"args", {{"name", buffer->name}}}});
+
+        const size_t capacity = buffer->events.size();
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(buffer->recorded, capacity));
+        droppedCount += buffer->recorded - count;
+        // 环已写满时最早的事件位于 next
+        const size_t begin = buffer->recorded > capacity ? buffer->next : 0;
+        for (size_t i = 0; i < count; ++i) {
+            const Event& event = buffer->events[(begin + i) % capacity];
+            const double ts = toMicros(event.startNs, originNs);
+            nlohmann::json args = nlohmann::json::object();
+            if (!event.detail.empty()) {
+                args["detail"] = event.detail;
+            }
+            if (event.async) {
+                ++asyncId;
+                emit({{"name", event.name}, {"cat", "io"}, {"ph", "b"}, {"id", asyncId}, {"ts", ts},
+                      {"pid", 1}, {"tid", buffer->tid}, {"args", args}});
+                emit({{"name", event.name}, {"cat", "io"}, {"ph", "e"}, {"id", asyncId}, {"ts", toMicros(event.endNs, originNs)},
+                      {"pid", 1}, {"tid", buffer->tid}});
+            } else {
+                emit({{"name", event.name}, {"cat", "stage"}, {"ph", "X"}, {"ts", ts},
+                      {"dur", (event.endNs - event.startNs) / 1000.0}, {"pid", 1}, {"tid", buffer->tid}, {"args", args}});
+            }
+            eventCount++;
+        }
+    }
+    out << "\n],\"otherData\":{\"droppedEvents\":" << droppedCount << "}}\n";
+    out.flush();
+    if (!out) {
+        LOG_ERROR << "Error: Failed to write trace file " << outputPath.string();
+        return false;
+    }
+
+    LOG_INFO << "Trace written to " << outputPath.string() << " (" << eventCount << " event(s) on "
+             << buffers.size() << " thread(s)" << (droppedCount > 0 ? ", oldest " + std::to_string(droppedCount) + " overwritten" : std::string()) << ").";
+    return true;
+}
+
+} // namespace Trace
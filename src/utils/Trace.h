@@ -0,0 +1,106 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "AllocationTracker.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 按阶段的耗时跟踪（--trace），导出为 Chrome Trace Event JSON，可直接在 Perfetto 或 chrome://tracing 中打开。
+// 每个线程写自己的固定容量环形缓冲区，写满后覆盖最早的事件；线程之间没有共享的热点。
+// 未启用（且当前线程没有收集阶段耗时）时一个 Span 只是几次读取，不读时钟也不分配内存。
+// 每个 Span 同时是一个 AllocationTracker::Scope：--track-allocations 的阶段与这里的阶段一致。
+namespace Trace {
+
+    static constexpr size_t DEFAULT_EVENTS_PER_THREAD = 1 << 16;
+
+    // 一张图片各阶段的耗时之和（--report）。用 ScopedStageTimes 安装到当前线程后，
+    // 该线程上结束的每个 Span 都累加进来，与是否启用 --trace 无关。
+    struct StageTimes {
+        std::vector<std::pair<const char*, uint64_t>> totalsNs; // 按首次出现的顺序
+        void add(const char* name, uint64_t ns);
+    };
+
+    namespace detail {
+        inline std::atomic<bool> enabled{false};
+        inline thread_local StageTimes* stageTimes = nullptr;
+    }
+
+    class ScopedStageTimes {
+    public:
+        explicit ScopedStageTimes(StageTimes* times) : m_previous(detail::stageTimes) { detail::stageTimes = times; }
+        ~ScopedStageTimes() { detail::stageTimes = m_previous; }
+
+        ScopedStageTimes(const ScopedStageTimes&) = delete;
+        ScopedStageTimes& operator=(const ScopedStageTimes&) = delete;
+
+    private:
+        StageTimes* m_previous;
+    };
+
+    inline bool isEnabled() {
+        return detail::enabled.load(std::memory_order_relaxed);
+    }
+
+    // 开始记录；应在创建工作线程之前调用
+    void start(size_t eventsPerThread = DEFAULT_EVENTS_PER_THREAD);
+
+    // 写出所有线程记录的事件。应在工作线程都已空闲后调用
+    bool writeChromeTrace(const std::filesystem::path& outputPath);
+
+    // 当前线程在时间线上显示的名称（未启用时也可调用，之后启用时生效）
+    void setThreadName(const std::string& name);
+
+    uint64_t nowNs();
+
+    // 记录一段已结束的区间。async 为 true 时导出为异步事件，
+    // 用于同一线程上相互重叠的区间（例如 io_uring 同时在途的多个写入）
+    void record(const char* name, uint64_t startNs, uint64_t endNs, std::string detail = std::string(), bool async = false);
+
+    // 作用域内的一个阶段；name 必须是字符串字面量
+    class Span {
+    public:
+        explicit Span(const char* name)
+            : m_name(name), m_startNs((isEnabled() || detail::stageTimes) ? nowNs() : 0) {}
+        ~Span() {
+            if (m_startNs != 0) {
+                const uint64_t endNs = nowNs();
+                if (detail::stageTimes) {
+                    detail::stageTimes->add(m_name, endNs - m_startNs);
+                }
+                if (isEnabled()) {
+                    record(m_name, m_startNs, endNs, std::move(m_detail));
+                }
+            }
+        }
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+        bool active() const { return m_startNs != 0; }
+        void setDetail(std::string detail) { m_detail = std::move(detail); }
+        const AllocationTracker::Scope& allocations() const { return m_allocations; }
+
+    private:
+        const char* m_name;
+        uint64_t m_startNs;
+        std::string m_detail;
+        AllocationTracker::Scope m_allocations{m_name};
+    };
+
+} // namespace Trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SPAN(name) Trace::Span TRACE_CONCAT(traceSpan_, __LINE__)(name)
+// detail 表达式（例如文件名）只在启用跟踪时求值
+#define TRACE_SPAN_DETAIL(name, detail)                                   \
+    Trace::Span TRACE_CONCAT(traceSpan_, __LINE__)(name);                 \
+    if (TRACE_CONCAT(traceSpan_, __LINE__).active() && Trace::isEnabled()) \
+        TRACE_CONCAT(traceSpan_, __LINE__).setDetail(detail)
+
+#endif // TRACE_H